@@ -0,0 +1,15 @@
+#include "Affine2D.h"
+#include "Rect.h"
+#include <cmath>
+
+Rect<float> Affine2D::TransformRect(const Rect<float>& rect) const
+{
+	const vec2 halfDim = vec2(rect.width, rect.height) * 0.5f;
+	const vec2 center = TransformPoint(rect.pos + halfDim);
+	const vec2 halfExtent = vec2
+	(
+		std::abs(data[0][0]) * halfDim.x + std::abs(data[1][0]) * halfDim.y,
+		std::abs(data[0][1]) * halfDim.x + std::abs(data[1][1]) * halfDim.y
+	);
+	return Rect<float>(center - halfExtent, halfExtent * 2.0f);
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include "Vector.h"
+
+template <typename type>
+class Rect;
+
+/*
+
+	Affine2D
+
+	The first two columns of a mat3 in the same data[x][y] layout, so points are still row vectors:
+	(x, y, 1) * transform, and a * b applies a before b.
+
+*/
+
+class Affine2D
+{
+public:
+	float data[3][2];
+public:
+	constexpr Affine2D()
+		:
+		Affine2D(Identity())
+	{}
+	constexpr Affine2D(float x1, float y1, float z1, float x2, float y2, float z2)
+	{
+		data[0][0] = x1; data[1][0] = y1; data[2][0] = z1;
+		data[0][1] = x2; data[1][1] = y2; data[2][1] = z2;
+	}
+	explicit constexpr Affine2D(const mat3& m3)
+		:
+		Affine2D
+		(
+			m3.data[0][0], m3.data[1][0], m3.data[2][0],
+			m3.data[0][1], m3.data[1][1], m3.data[2][1]
+		)
+	{
+		assert(m3.data[0][2] == 0.0f && m3.data[1][2] == 0.0f && m3.data[2][2] == 1.0f);
+	}
+	explicit constexpr Affine2D(const mat4& m4)
+		:
+		Affine2D
+		(
+			m4.data[0][0], m4.data[1][0], m4.data[3][0],
+			m4.data[0][1], m4.data[1][1], m4.data[3][1]
+		)
+	{}
+	constexpr Affine2D operator *(const Affine2D& a2) const
+	{
+		return Affine2D
+		(
+			data[0][0] * a2.data[0][0] + data[0][1] * a2.data[1][0],
+			data[1][0] * a2.data[0][0] + data[1][1] * a2.data[1][0],
+			data[2][0] * a2.data[0][0] + data[2][1] * a2.data[1][0] + a2.data[2][0],
+			data[0][0] * a2.data[0][1] + data[0][1] * a2.data[1][1],
+			data[1][0] * a2.data[0][1] + data[1][1] * a2.data[1][1],
+			data[2][0] * a2.data[0][1] + data[2][1] * a2.data[1][1] + a2.data[2][1]
+		);
+	}
+	constexpr Affine2D& operator *=(const Affine2D& a2)
+	{
+		return *this = *this * a2;
+	}
+	constexpr vec2 TransformPoint(const vec2& p) const
+	{
+		return vec2
+		(
+			p.x * data[0][0] + p.y * data[1][0] + data[2][0],
+			p.x * data[0][1] + p.y * data[1][1] + data[2][1]
+		);
+	}
+	constexpr vec2 TransformVector(const vec2& v) const
+	{
+		return vec2
+		(
+			v.x * data[0][0] + v.y * data[1][0],
+			v.x * data[0][1] + v.y * data[1][1]
+		);
+	}
+	// bounding box of the transformed rect, from its transformed center and the absolute linear part applied to its half extents
+	Rect<float> TransformRect(const Rect<float>& rect) const;
+	constexpr float Determinant() const
+	{
+		return data[0][0] * data[1][1] - data[0][1] * data[1][0];
+	}
+	constexpr bool isInvertible() const
+	{
+		return Determinant() != 0.0f;
+	}
+	constexpr Affine2D Inverse() const
+	{
+		assert(isInvertible());
+		const float invDet = 1.0f / Determinant();
+		const float i00 = data[1][1] * invDet;
+		const float i01 = -data[0][1] * invDet;
+		const float i10 = -data[1][0] * invDet;
+		const float i11 = data[0][0] * invDet;
+		return Affine2D
+		(
+			i00, i10, -(data[2][0] * i00 + data[2][1] * i10),
+			i01, i11, -(data[2][0] * i01 + data[2][1] * i11)
+		);
+	}
+	constexpr vec2 GetTranslation() const
+	{
+		return vec2(data[2][0], data[2][1]);
+	}
+	constexpr mat3 ToMat3() const
+	{
+		return mat3
+		(
+			data[0][0],	data[1][0],	data[2][0],
+			data[0][1],	data[1][1],	data[2][1],
+			0.0f,		0.0f,		1.0f
+		);
+	}
+	// translation goes in the w row, matching mat4::Translation and the (x, y, 0, 1) positions fed to the vertex shaders
+	constexpr mat4 ToMat4() const
+	{
+		return mat4
+		(
+			data[0][0],	data[1][0],	0.0f,	data[2][0],
+			data[0][1],	data[1][1],	0.0f,	data[2][1],
+			0.0f,		0.0f,		1.0f,	0.0f,
+			0.0f,		0.0f,		0.0f,	1.0f
+		);
+	}
+public:
+	static constexpr Affine2D Identity()
+	{
+		return Affine2D
+		(
+			1.0f,	0.0f,	0.0f,
+			0.0f,	1.0f,	0.0f
+		);
+	}
+	static constexpr Affine2D Scaling(const float& xScale, const float& yScale)
+	{
+		return Affine2D
+		(
+			xScale,	0.0f,	0.0f,
+			0.0f,	yScale,	0.0f
+		);
+	}
+	static constexpr Affine2D Rotation(const float& radians)
+	{
+		const float cosR = (float)cos((double)radians);
+		const float sinR = (float)sin((double)radians);
+		return Affine2D
+		(
+			cosR,	-sinR,	0.0f,
+			sinR,	cosR,	0.0f
+		);
+	}
+	static constexpr Affine2D Translation(const float& xTrans, const float& yTrans)
+	{
+		return Affine2D
+		(
+			1.0f,	0.0f,	xTrans,
+			0.0f,	1.0f,	yTrans
+		);
+	}
+	// rotate, then scale, then translate; the order Transformable and the graphics layers use
+	static constexpr Affine2D RotationScalingTranslation(const float& radians, const vec2& scale, const vec2& translation)
+	{
+		const float cosR = (float)cos((double)radians);
+		const float sinR = (float)sin((double)radians);
+		return Affine2D
+		(
+			cosR * scale.x,	-sinR * scale.x,	translation.x,
+			sinR * scale.y,	cosR * scale.y,		translation.y
+		);
+	}
+};
@@ -1,114 +1,140 @@
 #include "Animation.h"
+#include <cfloat>
 
 Animation::Animation(Image sprite_sheet, uint2 sprite_size, uint2 sheet_dim, unsigned int fps)
 	:
-	currentFrame(0u),
-	frameWidth(sprite_size.x),
-	frameHeight(sprite_size.y),
-	nFrames(sheet_dim.x * sheet_dim.y),
-	currentFrameTime(0.0f),
-	secsPerFrame(1.0f / (float)fps)
-{
-	assert(sprite_size.x * sheet_dim.x == sprite_sheet.GetWidth());
-	assert(sprite_size.y * sheet_dim.y == sprite_sheet.GetHeight());
-	frames.resize(nFrames);
-	for (unsigned int y = 0u; y < sheet_dim.y; ++y)
-	{
-		for (unsigned int x = 0u; x < sheet_dim.x; ++x)
-		{
-			frames[y * sheet_dim.x + x] = sprite_sheet.Cropped(sprite_size.x, sprite_size.y, x * sprite_size.x, y * sprite_size.y);
-		}
-	}
+	pFrames(std::make_shared<AnimationFrames>(sprite_sheet, sprite_size, sheet_dim, fps)),
+	instance()
+{}
+
+Animation::Animation(std::shared_ptr<const AnimationFrames> frames, AnimationInstance instance)
+	:
+	pFrames(std::move(frames)),
+	instance(instance)
+{
+	assert(instance.GetFrameIndex() < pFrames->GetFrameCount());
 }
 
 const unsigned int& Animation::GetFrameWidth() const
 {
-	return frameWidth;
+	return pFrames->GetFrameWidth();
 }
 
 const unsigned int& Animation::GetFrameHeight() const
 {
-	return frameHeight;
+	return pFrames->GetFrameHeight();
 }
 
 vec2u Animation::GetFrameSize() const
 {
-	return { frameWidth,frameHeight };
+	return pFrames->GetFrameSize();
+}
+
+const unsigned int& Animation::GetFrameCount() const
+{
+	return pFrames->GetFrameCount();
+}
+
+const Image& Animation::GetFrame(unsigned int index) const
+{
+	return pFrames->GetFrame(index);
+}
+
+const std::shared_ptr<const AnimationFrames>& Animation::GetFrames() const
+{
+	return pFrames;
+}
+
+AnimationInstance& Animation::GetInstance()
+{
+	return instance;
+}
+
+const AnimationInstance& Animation::GetInstance() const
+{
+	return instance;
 }
 
 const unsigned int& Animation::GetCurrentFrameIndex() const
 {
-	return currentFrame;
+	return instance.GetFrameIndex();
 }
 
 void Animation::SetCurrentFrameIndex(unsigned int frame)
 {
-	currentFrame = frame;
+	assert(frame < pFrames->GetFrameCount());
+	instance.SetFrameIndex(frame);
 }
 
 const float& Animation::GetCurrentFrameTime() const
 {
-	return currentFrameTime;
+	return instance.GetFrameTime();
 }
 
 void Animation::SetCurrentFrameTime(float time)
 {
-	currentFrameTime = time;
+	instance.SetFrameTime(time);
+}
+
+float Animation::GetSecsPerFrame() const
+{
+	const float speed = instance.GetSpeed();
+	return speed > 0.0f ? pFrames->GetSecsPerFrame() / speed : FLT_MAX;
 }
 
 float Animation::GetFPS() const
 {
-	return 1.0f / secsPerFrame;
+	return pFrames->GetFPS() * instance.GetSpeed();
 }
 
 void Animation::SetFPS(unsigned int fps)
 {
-	secsPerFrame = 1.0f / (float)fps;
+	assert(fps > 0u);
+	instance.SetSpeed((float)fps * pFrames->GetSecsPerFrame());
+}
+
+void Animation::SetLoopMode(AnimationInstance::LoopMode loop_mode)
+{
+	instance.SetLoopMode(loop_mode);
+}
+
+void Animation::SetSpeed(float speed)
+{
+	instance.SetSpeed(speed);
+}
+
+bool Animation::IsFinished() const
+{
+	return instance.IsFinished(pFrames->GetFrameCount());
+}
+
+void Animation::Restart()
+{
+	instance.Restart();
 }
 
 const Image& Animation::GetCurrentFrame() const
 {
-	return frames[currentFrame];
+	return pFrames->GetFrame(instance);
 }
 
 const Image& Animation::Play(float time_ellapsed)
 {
-	currentFrameTime += time_ellapsed;
-	while (currentFrameTime >= secsPerFrame)
-	{
-		currentFrameTime -= secsPerFrame;
-		++currentFrame;
-		if (currentFrame >= nFrames)
-		{
-			currentFrame = 0u;
-		}
-	}
-	return frames[currentFrame];
+	pFrames->Advance(instance, time_ellapsed);
+	return pFrames->GetFrame(instance);
 }
 
 bool Animation::PlayAndCheck(float time_ellapsed)
 {
-	currentFrameTime += time_ellapsed;
-	bool frameChange = false;
-	while (currentFrameTime >= secsPerFrame)
-	{
-		currentFrameTime -= secsPerFrame;
-		++currentFrame;
-		if (currentFrame >= nFrames)
-		{
-			currentFrame = 0u;
-		}
-		frameChange = true;
-	}
-	return frameChange;
+	return pFrames->Advance(instance, time_ellapsed);
 }
 
 void Animation::Draw(Graphics& gfx, int x, int y, unsigned int layer) const
 {
-	frames[currentFrame].Draw(gfx, x, y, layer);
+	pFrames->GetFrame(instance).Draw(gfx, x, y, layer);
 }
 
 void Animation::DrawWithTransparency(Graphics& gfx, int x, int y, unsigned int layer) const
 {
-	frames[currentFrame].DrawWithTransparency(gfx, x, y, layer);
+	pFrames->GetFrame(instance).DrawWithTransparency(gfx, x, y, layer);
 }
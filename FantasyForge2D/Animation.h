@@ -1,34 +1,38 @@
 #pragma once
-#include "Image.h"
+#include "AnimationFrames.h"
+#include <memory>
 
 class Animation
 {
 private:
-	std::vector<Image> frames;
-	unsigned int currentFrame;
-	const unsigned int frameWidth;
-	const unsigned int frameHeight;
-	const unsigned int nFrames;
-	float currentFrameTime;
-	float secsPerFrame;
+	std::shared_ptr<const AnimationFrames> pFrames;
+	AnimationInstance instance;
 public:
 	Animation() = delete;
 	Animation(Image sprite_sheet, uint2 sprite_size, uint2 sheet_dim, unsigned int fps);
+	Animation(std::shared_ptr<const AnimationFrames> frames, AnimationInstance instance = AnimationInstance());
 	const unsigned int& GetFrameWidth() const;
 	const unsigned int& GetFrameHeight() const;
 	vec2u GetFrameSize() const;
+	const unsigned int& GetFrameCount() const;
+	const Image& GetFrame(unsigned int index) const;
+	const std::shared_ptr<const AnimationFrames>& GetFrames() const;
+	AnimationInstance& GetInstance();
+	const AnimationInstance& GetInstance() const;
 	const unsigned int& GetCurrentFrameIndex() const;
 	void SetCurrentFrameIndex(unsigned int frame);
 	const float& GetCurrentFrameTime() const;
 	void SetCurrentFrameTime(float time);
+	float GetSecsPerFrame() const;
 	float GetFPS() const;
 	void SetFPS(unsigned int fps);
+	void SetLoopMode(AnimationInstance::LoopMode loop_mode);
+	void SetSpeed(float speed);
+	bool IsFinished() const;
+	void Restart();
 	const Image& GetCurrentFrame() const;
 	const Image& Play(float time_ellapsed);
 	bool PlayAndCheck(float time_ellapsed);
 	void Draw(Graphics& gfx, int x, int y, unsigned int layer = 0u) const;
 	void DrawWithTransparency(Graphics& gfx, int x, int y, unsigned int layer = 0u) const;
 };
-
-
-
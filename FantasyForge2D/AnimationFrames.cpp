@@ -0,0 +1,81 @@
+#include "AnimationFrames.h"
+
+AnimationFrames::AnimationFrames(const Image& sprite_sheet, uint2 sprite_size, uint2 sheet_dim, unsigned int fps)
+	:
+	frameWidth(sprite_size.x),
+	frameHeight(sprite_size.y),
+	nFrames(sheet_dim.x * sheet_dim.y),
+	secsPerFrame(1.0f / (float)fps)
+{
+	assert(sprite_size.x * sheet_dim.x == sprite_sheet.GetWidth());
+	assert(sprite_size.y * sheet_dim.y == sprite_sheet.GetHeight());
+	frames.resize(nFrames);
+	for (unsigned int y = 0u; y < sheet_dim.y; ++y)
+	{
+		for (unsigned int x = 0u; x < sheet_dim.x; ++x)
+		{
+			frames[y * sheet_dim.x + x] = sprite_sheet.Cropped(sprite_size.x, sprite_size.y, x * sprite_size.x, y * sprite_size.y);
+		}
+	}
+}
+
+const unsigned int& AnimationFrames::GetFrameWidth() const
+{
+	return frameWidth;
+}
+
+const unsigned int& AnimationFrames::GetFrameHeight() const
+{
+	return frameHeight;
+}
+
+vec2u AnimationFrames::GetFrameSize() const
+{
+	return { frameWidth,frameHeight };
+}
+
+const unsigned int& AnimationFrames::GetFrameCount() const
+{
+	return nFrames;
+}
+
+const float& AnimationFrames::GetSecsPerFrame() const
+{
+	return secsPerFrame;
+}
+
+float AnimationFrames::GetFPS() const
+{
+	return 1.0f / secsPerFrame;
+}
+
+const Image& AnimationFrames::GetFrame(unsigned int index) const
+{
+	assert(index < nFrames);
+	return frames[index];
+}
+
+const Image& AnimationFrames::GetFrame(const AnimationInstance& instance) const
+{
+	return GetFrame(instance.GetFrameIndex());
+}
+
+bool AnimationFrames::Advance(AnimationInstance& instance, float time_ellapsed) const
+{
+	return instance.Advance(time_ellapsed, secsPerFrame, nFrames);
+}
+
+void AnimationFrames::Advance(std::vector<AnimationInstance>& instances, float time_ellapsed) const
+{
+	AnimationInstance::AdvanceAll(instances.data(), (unsigned int)instances.size(), time_ellapsed, secsPerFrame, nFrames);
+}
+
+void AnimationFrames::Draw(Graphics& gfx, const AnimationInstance& instance, int x, int y, unsigned int layer) const
+{
+	GetFrame(instance).Draw(gfx, x, y, layer);
+}
+
+void AnimationFrames::DrawWithTransparency(Graphics& gfx, const AnimationInstance& instance, int x, int y, unsigned int layer) const
+{
+	GetFrame(instance).DrawWithTransparency(gfx, x, y, layer);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "Image.h"
+#include "AnimationInstance.h"
+
+class AnimationFrames
+{
+private:
+	std::vector<Image> frames;
+	const unsigned int frameWidth;
+	const unsigned int frameHeight;
+	const unsigned int nFrames;
+	const float secsPerFrame;
+public:
+	AnimationFrames() = delete;
+	AnimationFrames(const Image& sprite_sheet, uint2 sprite_size, uint2 sheet_dim, unsigned int fps);
+	AnimationFrames(const AnimationFrames& frames) = delete;
+	AnimationFrames& operator =(const AnimationFrames& frames) = delete;
+	const unsigned int& GetFrameWidth() const;
+	const unsigned int& GetFrameHeight() const;
+	vec2u GetFrameSize() const;
+	const unsigned int& GetFrameCount() const;
+	const float& GetSecsPerFrame() const;
+	float GetFPS() const;
+	const Image& GetFrame(unsigned int index) const;
+	const Image& GetFrame(const AnimationInstance& instance) const;
+	bool Advance(AnimationInstance& instance, float time_ellapsed) const;
+	void Advance(std::vector<AnimationInstance>& instances, float time_ellapsed) const;
+	void Draw(Graphics& gfx, const AnimationInstance& instance, int x, int y, unsigned int layer = 0u) const;
+	void DrawWithTransparency(Graphics& gfx, const AnimationInstance& instance, int x, int y, unsigned int layer = 0u) const;
+};
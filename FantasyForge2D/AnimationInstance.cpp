@@ -0,0 +1,138 @@
+#include "AnimationInstance.h"
+#include <math.h>
+#include <assert.h>
+
+AnimationInstance::AnimationInstance(LoopMode loop_mode, float speed, unsigned int start_frame)
+	:
+	currentFrame(start_frame),
+	currentFrameTime(0.0f),
+	speed(speed),
+	loopMode(loop_mode),
+	isReversing(false)
+{
+	assert(speed >= 0.0f);
+}
+
+const unsigned int& AnimationInstance::GetFrameIndex() const
+{
+	return currentFrame;
+}
+
+void AnimationInstance::SetFrameIndex(unsigned int frame)
+{
+	currentFrame = frame;
+}
+
+const float& AnimationInstance::GetFrameTime() const
+{
+	return currentFrameTime;
+}
+
+void AnimationInstance::SetFrameTime(float time)
+{
+	currentFrameTime = time;
+}
+
+const float& AnimationInstance::GetSpeed() const
+{
+	return speed;
+}
+
+void AnimationInstance::SetSpeed(float speed)
+{
+	assert(speed >= 0.0f);
+	this->speed = speed;
+}
+
+const AnimationInstance::LoopMode& AnimationInstance::GetLoopMode() const
+{
+	return loopMode;
+}
+
+void AnimationInstance::SetLoopMode(LoopMode loop_mode)
+{
+	loopMode = loop_mode;
+	isReversing = false;
+}
+
+const bool& AnimationInstance::IsReversing() const
+{
+	return isReversing;
+}
+
+bool AnimationInstance::IsFinished(unsigned int nFrames) const
+{
+	return loopMode == LoopMode::Once && currentFrame == nFrames - 1u;
+}
+
+void AnimationInstance::Restart()
+{
+	currentFrame = 0u;
+	currentFrameTime = 0.0f;
+	isReversing = false;
+}
+
+bool AnimationInstance::Advance(float time_ellapsed, float secs_per_frame, unsigned int nFrames)
+{
+	assert(nFrames > 0u && currentFrame < nFrames);
+	currentFrameTime += time_ellapsed * speed;
+	if (currentFrameTime < secs_per_frame)
+	{
+		return false;
+	}
+	const float steps = floorf(currentFrameTime / secs_per_frame);
+	currentFrameTime -= steps * secs_per_frame;
+	if (currentFrameTime < 0.0f)
+	{
+		currentFrameTime = 0.0f;
+	}
+	const unsigned long long nSteps = (unsigned long long)steps;
+	switch (loopMode)
+	{
+		case LoopMode::Once:
+		{
+			const unsigned int lastFrame = nFrames - 1u;
+			if (currentFrame == lastFrame)
+			{
+				currentFrameTime = 0.0f;
+				return false;
+			}
+			if (nSteps >= lastFrame - currentFrame)
+			{
+				currentFrame = lastFrame;
+				currentFrameTime = 0.0f;
+			}
+			else
+			{
+				currentFrame += (unsigned int)nSteps;
+			}
+			break;
+		}
+		case LoopMode::PingPong:
+		{
+			if (nFrames > 1u)
+			{
+				const unsigned int period = 2u * (nFrames - 1u);
+				const unsigned int phase = isReversing ? period - currentFrame : currentFrame;
+				const unsigned int newPhase = (unsigned int)((phase + nSteps) % period);
+				isReversing = newPhase >= nFrames;
+				currentFrame = isReversing ? period - newPhase : newPhase;
+			}
+			break;
+		}
+		default:
+		{
+			currentFrame = (unsigned int)((currentFrame + nSteps) % nFrames);
+			break;
+		}
+	}
+	return true;
+}
+
+void AnimationInstance::AdvanceAll(AnimationInstance* instances, unsigned int count, float time_ellapsed, float secs_per_frame, unsigned int nFrames)
+{
+	for (unsigned int i = 0u; i < count; ++i)
+	{
+		instances[i].Advance(time_ellapsed, secs_per_frame, nFrames);
+	}
+}
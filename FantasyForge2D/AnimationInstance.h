@@ -0,0 +1,35 @@
+#pragma once
+
+class AnimationInstance
+{
+public:
+	enum class LoopMode : unsigned char
+	{
+		Loop,
+		Once,
+		PingPong
+	};
+private:
+	unsigned int currentFrame = 0u;
+	float currentFrameTime = 0.0f;
+	float speed = 1.0f;
+	LoopMode loopMode = LoopMode::Loop;
+	bool isReversing = false;
+public:
+	AnimationInstance() = default;
+	AnimationInstance(LoopMode loop_mode, float speed = 1.0f, unsigned int start_frame = 0u);
+	const unsigned int& GetFrameIndex() const;
+	void SetFrameIndex(unsigned int frame);
+	const float& GetFrameTime() const;
+	void SetFrameTime(float time);
+	const float& GetSpeed() const;
+	void SetSpeed(float speed);
+	const LoopMode& GetLoopMode() const;
+	void SetLoopMode(LoopMode loop_mode);
+	const bool& IsReversing() const;
+	bool IsFinished(unsigned int nFrames) const;
+	void Restart();
+	bool Advance(float time_ellapsed, float secs_per_frame, unsigned int nFrames);
+public:
+	static void AdvanceAll(AnimationInstance* instances, unsigned int count, float time_ellapsed, float secs_per_frame, unsigned int nFrames);
+};
@@ -0,0 +1,114 @@
+#include "AudioSink.h"
+#include "SoundSystem.h"
+#include <emmintrin.h>
+
+void NullSink::Write(const float* pFrames, unsigned int n_frames)
+{
+	nFramesWritten += n_frames;
+	if (n_frames > 0u)
+	{
+		checksum += pFrames[0] + pFrames[n_frames - 1u];
+	}
+}
+
+const unsigned long long& NullSink::GetFramesWritten() const
+{
+	return nFramesWritten;
+}
+
+const float& NullSink::GetChecksum() const
+{
+	return checksum;
+}
+
+void WavFileSink::WriteHeader()
+{
+	const unsigned short formatTag = asFloat ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM;
+	const unsigned short bitsPerSample = asFloat ? 32u : 16u;
+	const unsigned short blockAlign = (unsigned short)(nChannels * bitsPerSample / 8u);
+	const unsigned int bytesPerSec = sampleRate * blockAlign;
+	const unsigned short channels = (unsigned short)(nChannels);
+	const unsigned int riffSize = 36u + nDataBytes;
+	const unsigned int fmtSize = 16u;
+	wavOUT.seekp(0, std::ios::beg);
+	wavOUT.write("RIFF", 4);
+	wavOUT.write(reinterpret_cast<const char*>(&riffSize), 4);
+	wavOUT.write("WAVEfmt ", 8);
+	wavOUT.write(reinterpret_cast<const char*>(&fmtSize), 4);
+	wavOUT.write(reinterpret_cast<const char*>(&formatTag), 2);
+	wavOUT.write(reinterpret_cast<const char*>(&channels), 2);
+	wavOUT.write(reinterpret_cast<const char*>(&sampleRate), 4);
+	wavOUT.write(reinterpret_cast<const char*>(&bytesPerSec), 4);
+	wavOUT.write(reinterpret_cast<const char*>(&blockAlign), 2);
+	wavOUT.write(reinterpret_cast<const char*>(&bitsPerSample), 2);
+	wavOUT.write("data", 4);
+	wavOUT.write(reinterpret_cast<const char*>(&nDataBytes), 4);
+	wavOUT.seekp(0, std::ios::end);
+}
+
+WavFileSink::WavFileSink(const char* fileName, unsigned int sample_rate, unsigned int n_channels, bool as_float)
+	:
+	wavOUT(fileName, std::ios::binary),
+	sampleRate(sample_rate),
+	nChannels(n_channels),
+	asFloat(as_float)
+{
+	if (!wavOUT)
+	{
+		throw SNDEXCPT("Could not create .wav file!\n" + std::string(fileName));
+	}
+	WriteHeader();
+}
+
+void WavFileSink::Write(const float* pFrames, unsigned int n_frames)
+{
+	assert(wavOUT.is_open());
+	const unsigned int nSamples = n_frames * nChannels;
+	if (asFloat)
+	{
+		wavOUT.write(reinterpret_cast<const char*>(pFrames), nSamples * sizeof(float));
+		nDataBytes += nSamples * sizeof(float);
+		return;
+	}
+	if (nConverted < nSamples)
+	{
+		pConverted = std::make_unique<short[]>(nSamples);
+		nConverted = nSamples;
+	}
+	short* pOut = pConverted.get();
+	const __m128 scale = _mm_set1_ps(32767.0f);
+	const __m128 hi = _mm_set1_ps(1.0f);
+	const __m128 lo = _mm_set1_ps(-1.0f);
+	unsigned int i = 0u;
+	for (; i + 8u <= nSamples; i += 8u)
+	{
+		const __m128 a = _mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(pFrames + i), hi), lo), scale);
+		const __m128 b = _mm_mul_ps(_mm_max_ps(_mm_min_ps(_mm_loadu_ps(pFrames + i + 4u), hi), lo), scale);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + i), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+	}
+	for (; i < nSamples; ++i)
+	{
+		pOut[i] = short(std::lround(std::min(std::max(pFrames[i], -1.0f), 1.0f) * 32767.0f));
+	}
+	wavOUT.write(reinterpret_cast<const char*>(pOut), nSamples * sizeof(short));
+	nDataBytes += nSamples * sizeof(short);
+}
+
+void WavFileSink::Close()
+{
+	if (wavOUT.is_open())
+	{
+		WriteHeader();
+		wavOUT.close();
+	}
+}
+
+const unsigned int& WavFileSink::GetDataSize() const
+{
+	return nDataBytes;
+}
+
+WavFileSink::~WavFileSink()
+{
+	Close();
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <fstream>
+#include <memory>
+
+class AudioSink
+{
+public:
+	virtual void Write(const float* pFrames, unsigned int n_frames) = 0;
+	virtual ~AudioSink() = default;
+};
+
+class NullSink : public AudioSink
+{
+private:
+	unsigned long long nFramesWritten = 0u;
+	float checksum = 0.0f;
+public:
+	void Write(const float* pFrames, unsigned int n_frames) override;
+	const unsigned long long& GetFramesWritten() const;
+	const float& GetChecksum() const;
+};
+
+class WavFileSink : public AudioSink
+{
+private:
+	std::ofstream wavOUT;
+	const unsigned int sampleRate;
+	const unsigned int nChannels;
+	const bool asFloat;
+	unsigned int nDataBytes = 0u;
+	std::unique_ptr<short[]> pConverted;
+	unsigned int nConverted = 0u;
+private:
+	void WriteHeader();
+public:
+	WavFileSink() = delete;
+	WavFileSink(const char* fileName, unsigned int sample_rate, unsigned int n_channels = 2u, bool as_float = false);
+	WavFileSink(const WavFileSink& sink) = delete;
+	WavFileSink operator =(const WavFileSink& sink) = delete;
+	void Write(const float* pFrames, unsigned int n_frames) override;
+	void Close();
+	const unsigned int& GetDataSize() const;
+	~WavFileSink();
+};
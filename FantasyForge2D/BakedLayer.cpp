@@ -0,0 +1,408 @@
+#include "BakedLayer.h"
+#include <algorithm>
+#include <cfloat>
+
+BakedLayer::BakedLayer(uint2 region_dim, vec2 pos, unsigned int chunk_size)
+	:
+	position(pos),
+	width(region_dim.x),
+	height(region_dim.y),
+	chunkSize(chunk_size),
+	nChunksX((region_dim.x + chunk_size - 1u) / chunk_size),
+	nChunksY((region_dim.y + chunk_size - 1u) / chunk_size)
+{
+	assert(width > 0u && height > 0u);
+	assert(chunkSize > 0u);
+	chunks.resize(nChunksX * nChunksY);
+	for (unsigned int cy = 0u; cy < nChunksY; ++cy)
+	{
+		for (unsigned int cx = 0u; cx < nChunksX; ++cx)
+		{
+			const iRect rect = GetChunkRect(cx, cy);
+			Chunk& chunk = chunks[cy * nChunksX + cx];
+			chunk.image = Image((unsigned int)rect.width, (unsigned int)rect.height);
+			std::fill_n(chunk.image.GetPtrToImage(), rect.width * rect.height, Colors::Transparent);
+		}
+	}
+}
+
+iRect BakedLayer::CalculateBounds(const Item& item) const
+{
+	if (item.pImage)
+	{
+		return iRect({ (int)item.position.x,(int)item.position.y }, (int)item.pImage->GetWidth(), (int)item.pImage->GetHeight());
+	}
+	else if (item.pTile)
+	{
+		const fRect& rect = item.pTile->GetRect();
+		return iRect({ (int)rect.pos.x,(int)rect.pos.y }, (int)rect.width, (int)rect.height);
+	}
+	else
+	{
+		const Affine2D transform = item.pSVG->GetTransform();
+		vec2 topLeft = { FLT_MAX,FLT_MAX };
+		vec2 bottomRight = { -FLT_MAX,-FLT_MAX };
+		for (const auto& line : item.pSVG->GetLineBuffer())
+		{
+			for (const vec2& p : { line.first,line.second })
+			{
+				const vec2 v = transform.TransformPoint(p);
+				topLeft = { std::min(topLeft.x, v.x),std::min(topLeft.y, v.y) };
+				bottomRight = { std::max(bottomRight.x, v.x),std::max(bottomRight.y, v.y) };
+			}
+		}
+		const vec2i pos = { (int)floorf(topLeft.x),(int)floorf(topLeft.y) };
+		return iRect(pos, (int)ceilf(bottomRight.x) - pos.x + 1, (int)ceilf(bottomRight.y) - pos.y + 1);
+	}
+}
+
+iRect BakedLayer::GetChunkRect(unsigned int cx, unsigned int cy) const
+{
+	const unsigned int x = cx * chunkSize;
+	const unsigned int y = cy * chunkSize;
+	return iRect({ (int)x,(int)y }, (int)std::min(chunkSize, width - x), (int)std::min(chunkSize, height - y));
+}
+
+uRect BakedLayer::GetChunkRange(const iRect& region) const
+{
+	const unsigned int x0 = (unsigned int)std::clamp(region.pos.x, 0, (int)width) / chunkSize;
+	const unsigned int y0 = (unsigned int)std::clamp(region.pos.y, 0, (int)height) / chunkSize;
+	const unsigned int x1 = ((unsigned int)std::clamp(region.pos.x + region.width, 0, (int)width) + chunkSize - 1u) / chunkSize;
+	const unsigned int y1 = ((unsigned int)std::clamp(region.pos.y + region.height, 0, (int)height) + chunkSize - 1u) / chunkSize;
+	return uRect({ x0,y0 }, x1 - std::min(x0, x1), y1 - std::min(y0, y1));
+}
+
+void BakedLayer::Link(unsigned int item)
+{
+	const uRect range = GetChunkRange(items[item].bounds);
+	for (unsigned int cy = range.pos.y; cy < range.pos.y + range.height; ++cy)
+	{
+		for (unsigned int cx = range.pos.x; cx < range.pos.x + range.width; ++cx)
+		{
+			Chunk& chunk = chunks[cy * nChunksX + cx];
+			chunk.items.insert(std::lower_bound(chunk.items.begin(), chunk.items.end(), item), item);
+			MarkDirty(chunk);
+		}
+	}
+}
+
+void BakedLayer::Unlink(unsigned int item)
+{
+	const uRect range = GetChunkRange(items[item].bounds);
+	for (unsigned int cy = range.pos.y; cy < range.pos.y + range.height; ++cy)
+	{
+		for (unsigned int cx = range.pos.x; cx < range.pos.x + range.width; ++cx)
+		{
+			Chunk& chunk = chunks[cy * nChunksX + cx];
+			const auto it = std::lower_bound(chunk.items.begin(), chunk.items.end(), item);
+			if (it != chunk.items.end() && *it == item)
+			{
+				chunk.items.erase(it);
+			}
+			MarkDirty(chunk);
+		}
+	}
+}
+
+void BakedLayer::MarkDirty(Chunk& chunk)
+{
+	if (!chunk.isDirty)
+	{
+		chunk.isDirty = true;
+		++nDirtyChunks;
+	}
+}
+
+void BakedLayer::BakeChunk(unsigned int cx, unsigned int cy)
+{
+	Chunk& chunk = chunks[cy * nChunksX + cx];
+	const iRect rect = GetChunkRect(cx, cy);
+	std::fill_n(chunk.image.GetPtrToImage(), rect.width * rect.height, Colors::Transparent);
+	for (unsigned int i : chunk.items)
+	{
+		const Item& item = items[i];
+		if (item.pImage)
+		{
+			BlitImage(chunk.image, *item.pImage, item.bounds - rect.pos, item.hasTransparency);
+		}
+		else if (item.pTile)
+		{
+			BlitImage(chunk.image, item.pTile->GetImage(), item.bounds - rect.pos, item.hasTransparency);
+		}
+		else
+		{
+			const Affine2D transform = item.pSVG->GetTransform();
+			for (const auto& line : item.pSVG->GetLineBuffer())
+			{
+				const vec2 p0 = transform.TransformPoint(line.first);
+				const vec2 p1 = transform.TransformPoint(line.second);
+				RasterizeLine(chunk.image, vec2i((int)p0.x, (int)p0.y) - rect.pos, vec2i((int)p1.x, (int)p1.y) - rect.pos, item.color);
+			}
+		}
+	}
+	chunk.isDirty = false;
+}
+
+void BakedLayer::BlitImage(Image& target, const Image& source, iRect dest, bool with_transparency)
+{
+	const int x0 = std::max(dest.pos.x, 0);
+	const int y0 = std::max(dest.pos.y, 0);
+	const int x1 = std::min(dest.pos.x + dest.width, (int)target.GetWidth());
+	const int y1 = std::min(dest.pos.y + dest.height, (int)target.GetHeight());
+	if (x0 >= x1 || y0 >= y1)
+	{
+		return;
+	}
+	const unsigned int targetWidth = target.GetWidth();
+	const unsigned int sourceWidth = source.GetWidth();
+	Color* pTarget = target.GetPtrToImage();
+	const Color* pSource = source.GetPtrToImage();
+	if ((unsigned int)dest.width == sourceWidth && (unsigned int)dest.height == source.GetHeight())
+	{
+		for (int y = y0; y < y1; ++y)
+		{
+			const Color* pSrcRow = &pSource[(y - dest.pos.y) * sourceWidth + (x0 - dest.pos.x)];
+			Color* pDstRow = &pTarget[y * targetWidth + x0];
+			if (with_transparency)
+			{
+				for (int x = 0; x < x1 - x0; ++x)
+				{
+					if (pSrcRow[x].GetA())
+					{
+						pDstRow[x] = pSrcRow[x];
+					}
+				}
+			}
+			else
+			{
+				memcpy(pDstRow, pSrcRow, (x1 - x0) * sizeof(Color));
+			}
+		}
+	}
+	else
+	{
+		const float xPxlsPerPxl = (float)sourceWidth / (float)dest.width;
+		const float yPxlsPerPxl = (float)source.GetHeight() / (float)dest.height;
+		for (int y = y0; y < y1; ++y)
+		{
+			const Color* pSrcRow = &pSource[(unsigned int)((float)(y - dest.pos.y) * yPxlsPerPxl) * sourceWidth];
+			Color* pDstRow = &pTarget[y * targetWidth];
+			for (int x = x0; x < x1; ++x)
+			{
+				const Color& pxl = pSrcRow[(unsigned int)((float)(x - dest.pos.x) * xPxlsPerPxl)];
+				if (!with_transparency || pxl.GetA())
+				{
+					pDstRow[x] = pxl;
+				}
+			}
+		}
+	}
+}
+
+void BakedLayer::RasterizeLine(Image& target, vec2i p0, vec2i p1, const Color& color)
+{
+	const int targetWidth = (int)target.GetWidth();
+	const int targetHeight = (int)target.GetHeight();
+	Color* pTarget = target.GetPtrToImage();
+	const int nSteps = std::max(abs(p1.x - p0.x), abs(p1.y - p0.y));
+	const float dx = nSteps ? (float)(p1.x - p0.x) / (float)nSteps : 0.0f;
+	const float dy = nSteps ? (float)(p1.y - p0.y) / (float)nSteps : 0.0f;
+	for (int i = 0; i <= nSteps; ++i)
+	{
+		const int x = p0.x + (int)roundf(dx * (float)i);
+		const int y = p0.y + (int)roundf(dy * (float)i);
+		if (x >= 0 && x < targetWidth && y >= 0 && y < targetHeight)
+		{
+			pTarget[y * targetWidth + x] = color;
+		}
+	}
+}
+
+template <bool transparent>
+unsigned int BakedLayer::DrawChunks(Graphics& gfx, unsigned int layer) const
+{
+	const int layerWidth = (int)gfx.GetWidth(layer);
+	const int layerHeight = (int)gfx.GetHeight(layer);
+	const int originX = (int)position.x;
+	const int originY = (int)position.y;
+	unsigned int nDrawn = 0u;
+	for (unsigned int cy = 0u; cy < nChunksY; ++cy)
+	{
+		for (unsigned int cx = 0u; cx < nChunksX; ++cx)
+		{
+			const Chunk& chunk = chunks[cy * nChunksX + cx];
+			if (chunk.items.empty())
+			{
+				continue;
+			}
+			assert(!chunk.isDirty);
+			const int X = originX + (int)(cx * chunkSize);
+			const int Y = originY + (int)(cy * chunkSize);
+			if (X < layerWidth && X + (int)chunk.image.GetWidth() > 0 && Y < layerHeight && Y + (int)chunk.image.GetHeight() > 0)
+			{
+				if constexpr (transparent)
+				{
+					chunk.image.DrawWithTransparency(gfx, X, Y, layer);
+				}
+				else
+				{
+					chunk.image.Draw(gfx, X, Y, layer);
+				}
+				++nDrawn;
+			}
+		}
+	}
+	return nDrawn;
+}
+
+unsigned int BakedLayer::Add(const Image& image, vec2 pos, bool with_transparency)
+{
+	Item item;
+	item.pImage = &image;
+	item.position = pos;
+	item.hasTransparency = with_transparency;
+	item.bounds = CalculateBounds(item);
+	items.push_back(item);
+	Link((unsigned int)items.size() - 1u);
+	return (unsigned int)items.size() - 1u;
+}
+
+unsigned int BakedLayer::Add(const Tile& tile, bool with_transparency)
+{
+	Item item;
+	item.pTile = &tile;
+	item.hasTransparency = with_transparency;
+	item.bounds = CalculateBounds(item);
+	items.push_back(item);
+	Link((unsigned int)items.size() - 1u);
+	return (unsigned int)items.size() - 1u;
+}
+
+unsigned int BakedLayer::Add(const SVG& svg, const Color& color)
+{
+	Item item;
+	item.pSVG = &svg;
+	item.color = color;
+	item.bounds = CalculateBounds(item);
+	items.push_back(item);
+	Link((unsigned int)items.size() - 1u);
+	return (unsigned int)items.size() - 1u;
+}
+
+void BakedLayer::Remove(unsigned int item)
+{
+	assert(item < items.size() && items[item].isActive);
+	Unlink(item);
+	items[item].isActive = false;
+}
+
+void BakedLayer::Refresh(unsigned int item)
+{
+	assert(item < items.size() && items[item].isActive);
+	Unlink(item);
+	items[item].bounds = CalculateBounds(items[item]);
+	Link(item);
+}
+
+void BakedLayer::Invalidate(const iRect& region)
+{
+	const uRect range = GetChunkRange(region);
+	for (unsigned int cy = range.pos.y; cy < range.pos.y + range.height; ++cy)
+	{
+		for (unsigned int cx = range.pos.x; cx < range.pos.x + range.width; ++cx)
+		{
+			MarkDirty(chunks[cy * nChunksX + cx]);
+		}
+	}
+}
+
+void BakedLayer::InvalidateAll()
+{
+	for (Chunk& chunk : chunks)
+	{
+		MarkDirty(chunk);
+	}
+}
+
+void BakedLayer::Clear()
+{
+	items.clear();
+	for (Chunk& chunk : chunks)
+	{
+		chunk.items.clear();
+		MarkDirty(chunk);
+	}
+}
+
+bool BakedLayer::IsDirty() const
+{
+	return nDirtyChunks > 0u;
+}
+
+unsigned int BakedLayer::Bake()
+{
+	if (nDirtyChunks == 0u)
+	{
+		return 0u;
+	}
+	unsigned int nBaked = 0u;
+	for (unsigned int cy = 0u; cy < nChunksY; ++cy)
+	{
+		for (unsigned int cx = 0u; cx < nChunksX; ++cx)
+		{
+			if (chunks[cy * nChunksX + cx].isDirty)
+			{
+				BakeChunk(cx, cy);
+				++nBaked;
+			}
+		}
+	}
+	nDirtyChunks = 0u;
+	return nBaked;
+}
+
+void BakedLayer::Move(vec2 delta)
+{
+	position += delta;
+}
+
+void BakedLayer::SetPosition(vec2 pos)
+{
+	position = pos;
+}
+
+const vec2& BakedLayer::GetPosition() const
+{
+	return position;
+}
+
+vec2u BakedLayer::GetDimensions() const
+{
+	return { width,height };
+}
+
+const unsigned int& BakedLayer::GetChunkSize() const
+{
+	return chunkSize;
+}
+
+unsigned int BakedLayer::GetChunkCount() const
+{
+	return (unsigned int)chunks.size();
+}
+
+const Image& BakedLayer::GetChunkImage(unsigned int cx, unsigned int cy) const
+{
+	assert(cx < nChunksX && cy < nChunksY);
+	return chunks[cy * nChunksX + cx].image;
+}
+
+unsigned int BakedLayer::Draw(Graphics& gfx, unsigned int layer) const
+{
+	return DrawChunks<false>(gfx, layer);
+}
+
+unsigned int BakedLayer::DrawWithTransparency(Graphics& gfx, unsigned int layer) const
+{
+	return DrawChunks<true>(gfx, layer);
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "Image.h"
+#include "Tile.h"
+#include "SVG.h"
+
+class BakedLayer
+{
+private:
+	struct Item
+	{
+		const Image* pImage = nullptr;
+		const Tile* pTile = nullptr;
+		const SVG* pSVG = nullptr;
+		vec2 position = { 0.0f,0.0f };
+		Color color = Colors::White;
+		bool hasTransparency = true;
+		bool isActive = true;
+		iRect bounds;
+	};
+	struct Chunk
+	{
+		Image image;
+		std::vector<unsigned int> items;
+		bool isDirty = false;
+	};
+private:
+	vec2 position;
+	const unsigned int width;
+	const unsigned int height;
+	const unsigned int chunkSize;
+	const unsigned int nChunksX;
+	const unsigned int nChunksY;
+	std::vector<Chunk> chunks;
+	std::vector<Item> items;
+	unsigned int nDirtyChunks = 0u;
+private:
+	iRect CalculateBounds(const Item& item) const;
+	iRect GetChunkRect(unsigned int cx, unsigned int cy) const;
+	uRect GetChunkRange(const iRect& region) const;
+	void Link(unsigned int item);
+	void Unlink(unsigned int item);
+	void MarkDirty(Chunk& chunk);
+	void BakeChunk(unsigned int cx, unsigned int cy);
+	static void BlitImage(Image& target, const Image& source, iRect dest, bool with_transparency);
+	static void RasterizeLine(Image& target, vec2i p0, vec2i p1, const Color& color);
+	template <bool transparent>
+	unsigned int DrawChunks(Graphics& gfx, unsigned int layer) const;
+public:
+	BakedLayer() = delete;
+	BakedLayer(uint2 region_dim, vec2 pos = { 0.0f,0.0f }, unsigned int chunk_size = 128u);
+	unsigned int Add(const Image& image, vec2 pos, bool with_transparency = true);
+	unsigned int Add(const Tile& tile, bool with_transparency = true);
+	unsigned int Add(const SVG& svg, const Color& color);
+	void Remove(unsigned int item);
+	void Refresh(unsigned int item);
+	void Invalidate(const iRect& region);
+	void InvalidateAll();
+	void Clear();
+	bool IsDirty() const;
+	unsigned int Bake();
+	void Move(vec2 delta);
+	void SetPosition(vec2 pos);
+	const vec2& GetPosition() const;
+	vec2u GetDimensions() const;
+	const unsigned int& GetChunkSize() const;
+	unsigned int GetChunkCount() const;
+	const Image& GetChunkImage(unsigned int cx, unsigned int cy) const;
+	unsigned int Draw(Graphics& gfx, unsigned int layer = 0u) const;
+	unsigned int DrawWithTransparency(Graphics& gfx, unsigned int layer = 0u) const;
+};
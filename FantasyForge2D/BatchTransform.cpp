@@ -0,0 +1,266 @@
+#include "BatchTransform.h"
+#include "Clock.h"
+#include <emmintrin.h>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// two interleaved points per register: (x0, y0, x1, y1) * rows (m00, m01, m00, m01), (m10, m11, m10, m11) + (m20, m21, m20, m21)
+static void TransformInterleaved(const float* pIn, float* pOut, size_t n_points, __m128 r0, __m128 r1, __m128 r2)
+{
+	size_t i = 0u;
+	for (; i + 4u <= n_points; i += 4u)
+	{
+		const __m128 p01 = _mm_loadu_ps(pIn + i * 2u);
+		const __m128 p23 = _mm_loadu_ps(pIn + i * 2u + 4u);
+		const __m128 t01 = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_shuffle_ps(p01, p01, _MM_SHUFFLE(2, 2, 0, 0)), r0),
+			_mm_mul_ps(_mm_shuffle_ps(p01, p01, _MM_SHUFFLE(3, 3, 1, 1)), r1)), r2);
+		const __m128 t23 = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_shuffle_ps(p23, p23, _MM_SHUFFLE(2, 2, 0, 0)), r0),
+			_mm_mul_ps(_mm_shuffle_ps(p23, p23, _MM_SHUFFLE(3, 3, 1, 1)), r1)), r2);
+		_mm_storeu_ps(pOut + i * 2u, t01);
+		_mm_storeu_ps(pOut + i * 2u + 4u, t23);
+	}
+	for (; i < n_points; ++i)
+	{
+		const __m128 p = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(pIn + i * 2u));
+		const __m128 t = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 0, 0)), r0),
+			_mm_mul_ps(_mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 1, 1)), r1)), r2);
+		_mm_storel_pi(reinterpret_cast<__m64*>(pOut + i * 2u), t);
+	}
+}
+
+static void TransformSplit(const float* pXIn, const float* pYIn, float* pXOut, float* pYOut, size_t n_points, float a, float b, float c, float d, float tx, float ty)
+{
+	const __m128 m00 = _mm_set1_ps(a);
+	const __m128 m01 = _mm_set1_ps(b);
+	const __m128 m10 = _mm_set1_ps(c);
+	const __m128 m11 = _mm_set1_ps(d);
+	const __m128 m20 = _mm_set1_ps(tx);
+	const __m128 m21 = _mm_set1_ps(ty);
+	size_t i = 0u;
+	for (; i + 4u <= n_points; i += 4u)
+	{
+		const __m128 x = _mm_loadu_ps(pXIn + i);
+		const __m128 y = _mm_loadu_ps(pYIn + i);
+		_mm_storeu_ps(pXOut + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m00), _mm_mul_ps(y, m10)), m20));
+		_mm_storeu_ps(pYOut + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, m01), _mm_mul_ps(y, m11)), m21));
+	}
+	for (; i < n_points; ++i)
+	{
+		const float x = pXIn[i];
+		const float y = pYIn[i];
+		pXOut[i] = x * a + y * c + tx;
+		pYOut[i] = x * b + y * d + ty;
+	}
+}
+
+void BatchTransform::TransformPoints(const vec2* pIn, vec2* pOut, size_t n_points, const mat3& m)
+{
+	static_assert(sizeof(vec2) == 2u * sizeof(float), "vec2 arrays must be tightly packed floats");
+	TransformInterleaved(reinterpret_cast<const float*>(pIn), reinterpret_cast<float*>(pOut), n_points,
+		_mm_setr_ps(m.data[0][0], m.data[0][1], m.data[0][0], m.data[0][1]),
+		_mm_setr_ps(m.data[1][0], m.data[1][1], m.data[1][0], m.data[1][1]),
+		_mm_setr_ps(m.data[2][0], m.data[2][1], m.data[2][0], m.data[2][1]));
+}
+
+void BatchTransform::TransformPoints(const float* pXIn, const float* pYIn, float* pXOut, float* pYOut, size_t n_points, const mat3& m)
+{
+	TransformSplit(pXIn, pYIn, pXOut, pYOut, n_points, m.data[0][0], m.data[0][1], m.data[1][0], m.data[1][1], m.data[2][0], m.data[2][1]);
+}
+
+void BatchTransform::TransformDirections(const vec2* pIn, vec2* pOut, size_t n_directions, const mat3& m)
+{
+	TransformInterleaved(reinterpret_cast<const float*>(pIn), reinterpret_cast<float*>(pOut), n_directions,
+		_mm_setr_ps(m.data[0][0], m.data[0][1], m.data[0][0], m.data[0][1]),
+		_mm_setr_ps(m.data[1][0], m.data[1][1], m.data[1][0], m.data[1][1]),
+		_mm_setzero_ps());
+}
+
+void BatchTransform::TransformPoints(const vec2* pIn, vec2* pOut, size_t n_points, const Affine2D& transform)
+{
+	TransformInterleaved(reinterpret_cast<const float*>(pIn), reinterpret_cast<float*>(pOut), n_points,
+		_mm_setr_ps(transform.data[0][0], transform.data[0][1], transform.data[0][0], transform.data[0][1]),
+		_mm_setr_ps(transform.data[1][0], transform.data[1][1], transform.data[1][0], transform.data[1][1]),
+		_mm_setr_ps(transform.data[2][0], transform.data[2][1], transform.data[2][0], transform.data[2][1]));
+}
+
+void BatchTransform::TransformPoints(const float* pXIn, const float* pYIn, float* pXOut, float* pYOut, size_t n_points, const Affine2D& transform)
+{
+	TransformSplit(pXIn, pYIn, pXOut, pYOut, n_points,
+		transform.data[0][0], transform.data[0][1], transform.data[1][0], transform.data[1][1], transform.data[2][0], transform.data[2][1]);
+}
+
+void BatchTransform::TransformDirections(const vec2* pIn, vec2* pOut, size_t n_directions, const Affine2D& transform)
+{
+	TransformInterleaved(reinterpret_cast<const float*>(pIn), reinterpret_cast<float*>(pOut), n_directions,
+		_mm_setr_ps(transform.data[0][0], transform.data[0][1], transform.data[0][0], transform.data[0][1]),
+		_mm_setr_ps(transform.data[1][0], transform.data[1][1], transform.data[1][0], transform.data[1][1]),
+		_mm_setzero_ps());
+}
+
+mat3 BatchTransform::Multiply(const mat3& lhs, const mat3& rhs)
+{
+	// rows 0 and 1 are loaded and stored four wide; the spilled lane lands on the next row, which is written after it
+	const __m128 b0 = _mm_loadu_ps(rhs.data[0]);
+	const __m128 b1 = _mm_loadu_ps(rhs.data[1]);
+	const __m128 b2 = _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(rhs.data[2])), _mm_load_ss(&rhs.data[2][2]));
+	mat3 result;
+	for (unsigned int i = 0u; i < 3u; ++i)
+	{
+		const __m128 row = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_set1_ps(lhs.data[i][0]), b0),
+			_mm_mul_ps(_mm_set1_ps(lhs.data[i][1]), b1)),
+			_mm_mul_ps(_mm_set1_ps(lhs.data[i][2]), b2));
+		if (i < 2u)
+		{
+			_mm_storeu_ps(result.data[i], row);
+		}
+		else
+		{
+			_mm_storel_pi(reinterpret_cast<__m64*>(result.data[i]), row);
+			_mm_store_ss(&result.data[i][2], _mm_movehl_ps(row, row));
+		}
+	}
+	return result;
+}
+
+mat4 BatchTransform::Multiply(const mat4& lhs, const mat4& rhs)
+{
+	const __m128 b0 = _mm_loadu_ps(rhs.data[0]);
+	const __m128 b1 = _mm_loadu_ps(rhs.data[1]);
+	const __m128 b2 = _mm_loadu_ps(rhs.data[2]);
+	const __m128 b3 = _mm_loadu_ps(rhs.data[3]);
+	mat4 result;
+	for (unsigned int i = 0u; i < 4u; ++i)
+	{
+		const __m128 row = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_set1_ps(lhs.data[i][0]), b0),
+			_mm_mul_ps(_mm_set1_ps(lhs.data[i][1]), b1)),
+			_mm_mul_ps(_mm_set1_ps(lhs.data[i][2]), b2)),
+			_mm_mul_ps(_mm_set1_ps(lhs.data[i][3]), b3));
+		_mm_storeu_ps(result.data[i], row);
+	}
+	return result;
+}
+
+BatchTransform::BenchmarkResult BatchTransform::Benchmark(size_t n_points, unsigned int n_matrices, unsigned int n_passes)
+{
+	// fixed-seed inputs so runs are comparable; every kernel is checked against the scalar templates it replaces
+	unsigned int seed = 0x9E3779B9u;
+	auto next = [&seed]()
+	{
+		seed = seed * 1664525u + 1013904223u;
+		return float(seed >> 8u) / float(1u << 24u) * 2.0f - 1.0f;
+	};
+	std::vector<vec2> points(n_points);
+	std::vector<float> xs(n_points);
+	std::vector<float> ys(n_points);
+	for (size_t i = 0u; i < n_points; ++i)
+	{
+		points[i] = { next() * 512.0f,next() * 512.0f };
+		xs[i] = points[i].x;
+		ys[i] = points[i].y;
+	}
+	std::vector<mat3> mat3s(n_matrices);
+	std::vector<mat4> mat4s(n_matrices);
+	for (unsigned int i = 0u; i < n_matrices; ++i)
+	{
+		for (unsigned int y = 0u; y < 4u; ++y)
+		{
+			for (unsigned int x = 0u; x < 4u; ++x)
+			{
+				mat4s[i].data[x][y] = next();
+				if (x < 3u && y < 3u)
+				{
+					mat3s[i].data[x][y] = mat4s[i].data[x][y];
+				}
+			}
+		}
+	}
+	const mat3 transform = mat3::RotationZ(0.7f) * mat3::Scaling(1.5f, 0.75f, 1.0f) * mat3::Translation(12.0f, -3.0f);
+	std::vector<vec2> scalarPoints(n_points);
+	std::vector<vec2> aosPoints(n_points);
+	std::vector<float> soaXs(n_points);
+	std::vector<float> soaYs(n_points);
+	std::vector<mat3> scalarMat3s(n_matrices);
+	std::vector<mat3> simdMat3s(n_matrices);
+	std::vector<mat4> scalarMat4s(n_matrices);
+	std::vector<mat4> simdMat4s(n_matrices);
+	BenchmarkResult result = {};
+	Clock timer;
+	for (unsigned int pass = 0u; pass < n_passes; ++pass)
+	{
+		for (size_t i = 0u; i < n_points; ++i)
+		{
+			const vec3 v = vec3(points[i].x, points[i].y, 1.0f) * transform;
+			scalarPoints[i] = { v.x,v.y };
+		}
+	}
+	result.scalarPointTime = timer.Mark();
+	for (unsigned int pass = 0u; pass < n_passes; ++pass)
+	{
+		TransformPoints(points.data(), aosPoints.data(), n_points, transform);
+	}
+	result.aosPointTime = timer.Mark();
+	for (unsigned int pass = 0u; pass < n_passes; ++pass)
+	{
+		TransformPoints(xs.data(), ys.data(), soaXs.data(), soaYs.data(), n_points, transform);
+	}
+	result.soaPointTime = timer.Mark();
+	for (unsigned int pass = 0u; pass < n_passes; ++pass)
+	{
+		for (unsigned int i = 0u; i < n_matrices; ++i)
+		{
+			scalarMat3s[i] = mat3s[i] * mat3s[(i + 1u) % n_matrices];
+		}
+	}
+	result.scalarMat3Time = timer.Mark();
+	for (unsigned int pass = 0u; pass < n_passes; ++pass)
+	{
+		for (unsigned int i = 0u; i < n_matrices; ++i)
+		{
+			simdMat3s[i] = Multiply(mat3s[i], mat3s[(i + 1u) % n_matrices]);
+		}
+	}
+	result.simdMat3Time = timer.Mark();
+	for (unsigned int pass = 0u; pass < n_passes; ++pass)
+	{
+		for (unsigned int i = 0u; i < n_matrices; ++i)
+		{
+			scalarMat4s[i] = mat4s[i] * mat4s[(i + 1u) % n_matrices];
+		}
+	}
+	result.scalarMat4Time = timer.Mark();
+	for (unsigned int pass = 0u; pass < n_passes; ++pass)
+	{
+		for (unsigned int i = 0u; i < n_matrices; ++i)
+		{
+			simdMat4s[i] = Multiply(mat4s[i], mat4s[(i + 1u) % n_matrices]);
+		}
+	}
+	result.simdMat4Time = timer.Mark();
+	for (size_t i = 0u; i < n_points; ++i)
+	{
+		result.maxPointError = std::max({ result.maxPointError,
+			std::abs(aosPoints[i].x - scalarPoints[i].x), std::abs(aosPoints[i].y - scalarPoints[i].y),
+			std::abs(soaXs[i] - scalarPoints[i].x), std::abs(soaYs[i] - scalarPoints[i].y) });
+	}
+	for (unsigned int i = 0u; i < n_matrices; ++i)
+	{
+		for (unsigned int y = 0u; y < 4u; ++y)
+		{
+			for (unsigned int x = 0u; x < 4u; ++x)
+			{
+				result.maxMatrixError = std::max(result.maxMatrixError, std::abs(simdMat4s[i].data[x][y] - scalarMat4s[i].data[x][y]));
+				if (x < 3u && y < 3u)
+				{
+					result.maxMatrixError = std::max(result.maxMatrixError, std::abs(simdMat3s[i].data[x][y] - scalarMat3s[i].data[x][y]));
+				}
+			}
+		}
+	}
+	return result;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "Affine2D.h"
+#include <stddef.h>
+
+class BatchTransform
+{
+public:
+	struct BenchmarkResult
+	{
+		float scalarPointTime;
+		float aosPointTime;
+		float soaPointTime;
+		float scalarMat3Time;
+		float simdMat3Time;
+		float scalarMat4Time;
+		float simdMat4Time;
+		float maxPointError;
+		float maxMatrixError;
+	};
+public:
+	// points are row vectors (x, y, 1) transformed like vec3(p.x, p.y, 1.0f) * m, so the third column of m is ignored;
+	// input and output may be the same buffer
+	static void TransformPoints(const vec2* pIn, vec2* pOut, size_t n_points, const mat3& m);
+	static void TransformPoints(const float* pXIn, const float* pYIn, float* pXOut, float* pYOut, size_t n_points, const mat3& m);
+	static void TransformDirections(const vec2* pIn, vec2* pOut, size_t n_directions, const mat3& m);
+	static void TransformPoints(const vec2* pIn, vec2* pOut, size_t n_points, const Affine2D& transform);
+	static void TransformPoints(const float* pXIn, const float* pYIn, float* pXOut, float* pYOut, size_t n_points, const Affine2D& transform);
+	static void TransformDirections(const vec2* pIn, vec2* pOut, size_t n_directions, const Affine2D& transform);
+	static mat3 Multiply(const mat3& lhs, const mat3& rhs);
+	static mat4 Multiply(const mat4& lhs, const mat4& rhs);
+	static BenchmarkResult Benchmark(size_t n_points = 1u << 16u, unsigned int n_matrices = 1u << 16u, unsigned int n_passes = 16u);
+};
@@ -59,12 +59,17 @@ const float& Camera2D::GetZoom() const
 	return zoom;
 }
 
-mat3 Camera2D::GetTransformationMatrix() const
+Affine2D Camera2D::GetTransform() const
 {
 	return
-		mat3::Translation(-position.x, -position.y) *
-		mat3::RotationZ(-rotation) *
-		mat3::Scaling(zoom, zoom, 1.0f);
+		Affine2D::Translation(-position.x, -position.y) *
+		Affine2D::Rotation(-rotation) *
+		Affine2D::Scaling(zoom, zoom);
+}
+
+mat3 Camera2D::GetTransformationMatrix() const
+{
+	return GetTransform().ToMat3();
 }
 
 mat4 Camera2D::GetTransformationMatrix4D() const
@@ -1,5 +1,5 @@
 #pragma once
-#include "Vector.h"
+#include "Affine2D.h"
 
 class Camera2D
 {
@@ -19,6 +19,7 @@ public:
 	void Zoom(float zoom_factor);
 	void SetZoom(float new_zoom);
 	const float& GetZoom() const;
+	Affine2D GetTransform() const;
 	mat3 GetTransformationMatrix() const;
 	mat4 GetTransformationMatrix4D() const;
 };
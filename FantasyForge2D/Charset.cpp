@@ -0,0 +1,191 @@
+#include "Charset.h"
+#include "BaseException.h"
+#include <fstream>
+#include <assert.h>
+#include <emmintrin.h>
+
+std::mutex Charset::registryMutex;
+std::unordered_map<std::string, std::shared_ptr<const Charset>> Charset::registry;
+
+Charset::Charset(const Image& charset, uchar2 char_table_dim, unsigned char start_char)
+	:
+	characterWidth((unsigned char)(charset.GetWidth() / char_table_dim.x)),
+	characterHeight((unsigned char)(charset.GetHeight() / char_table_dim.y)),
+	startChar(start_char),
+	charTableDim(char_table_dim),
+	maskPitch((characterWidth + 31u) / 32u)
+{
+	assert(characterWidth > 0u && characterHeight > 0u);
+	const unsigned int nChars = GetCharCount();
+	masks.assign(nChars * characterHeight * maskPitch, 0u);
+	for (unsigned int i = 0u; i < nChars; ++i)
+	{
+		const unsigned int xOff = (i % charTableDim.x) * characterWidth;
+		const unsigned int yOff = (i / charTableDim.x) * characterHeight;
+		for (unsigned int y = 0u; y < characterHeight; ++y)
+		{
+			unsigned int* pMaskRow = &masks[(i * characterHeight + y) * maskPitch];
+			for (unsigned int x = 0u; x < characterWidth; ++x)
+			{
+				pMaskRow[x / 32u] |= (unsigned int)(charset.GetPixel(xOff + x, yOff + y) != Colors::White) << (x % 32u);
+			}
+		}
+	}
+}
+
+Charset::Charset(const char* precompiled_filename)
+{
+	std::ifstream charsetIN{ precompiled_filename, std::ios::binary };
+	if (charsetIN.fail())
+	{
+		throw EXCPT_NOTE("Precompiled charset file not found! Check directory and/or file name spelling and retry.");
+	}
+	char magic[4] = {};
+	unsigned int version = 0u;
+	charsetIN.read(magic, sizeof(magic));
+	charsetIN.read(reinterpret_cast<char*>(&version), sizeof(version));
+	if (charsetIN.fail() || magic[0] != 'F' || magic[1] != 'F' || magic[2] != 'C' || magic[3] != 'S')
+	{
+		throw EXCPT_NOTE("File is not a precompiled charset! Recompile the charset with Charset::Save and retry.");
+	}
+	if (version != FileVersion)
+	{
+		throw EXCPT_NOTE("Precompiled charset version mismatch! Recompile the charset with Charset::Save and retry.");
+	}
+	charsetIN.read(reinterpret_cast<char*>(&characterWidth), sizeof(characterWidth));
+	charsetIN.read(reinterpret_cast<char*>(&characterHeight), sizeof(characterHeight));
+	charsetIN.read(reinterpret_cast<char*>(&startChar), sizeof(startChar));
+	charsetIN.read(reinterpret_cast<char*>(&charTableDim.x), sizeof(charTableDim.x));
+	charsetIN.read(reinterpret_cast<char*>(&charTableDim.y), sizeof(charTableDim.y));
+	maskPitch = (characterWidth + 31u) / 32u;
+	masks.resize(GetCharCount() * characterHeight * maskPitch);
+	charsetIN.read(reinterpret_cast<char*>(masks.data()), masks.size() * sizeof(unsigned int));
+	if (charsetIN.fail() || characterWidth == 0u || characterHeight == 0u)
+	{
+		throw EXCPT_NOTE("Precompiled charset file is truncated or corrupt! Recompile the charset with Charset::Save and retry.");
+	}
+}
+
+const unsigned char& Charset::GetCharacterWidth() const
+{
+	return characterWidth;
+}
+
+const unsigned char& Charset::GetCharacterHeight() const
+{
+	return characterHeight;
+}
+
+const unsigned char& Charset::GetStartChar() const
+{
+	return startChar;
+}
+
+const uchar2& Charset::GetCharTableDim() const
+{
+	return charTableDim;
+}
+
+unsigned int Charset::GetCharCount() const
+{
+	return charTableDim.x * charTableDim.y;
+}
+
+bool Charset::HasChar(unsigned char chr) const
+{
+	return chr >= startChar && chr < startChar + GetCharCount();
+}
+
+bool Charset::IsPixelSet(unsigned char index, unsigned int x, unsigned int y) const
+{
+	assert(index < GetCharCount());
+	assert(x < characterWidth && y < characterHeight);
+	return (masks[(index * characterHeight + y) * maskPitch + x / 32u] >> (x % 32u)) & 1u;
+}
+
+void Charset::Save(const char* filename) const
+{
+	std::ofstream charsetOUT{ filename, std::ios::binary };
+	if (charsetOUT.fail())
+	{
+		throw EXCPT_NOTE("Unable to create precompiled charset file! Check directory and retry.");
+	}
+	const unsigned int version = FileVersion;
+	charsetOUT.write("FFCS", 4);
+	charsetOUT.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	charsetOUT.write(reinterpret_cast<const char*>(&characterWidth), sizeof(characterWidth));
+	charsetOUT.write(reinterpret_cast<const char*>(&characterHeight), sizeof(characterHeight));
+	charsetOUT.write(reinterpret_cast<const char*>(&startChar), sizeof(startChar));
+	charsetOUT.write(reinterpret_cast<const char*>(&charTableDim.x), sizeof(charTableDim.x));
+	charsetOUT.write(reinterpret_cast<const char*>(&charTableDim.y), sizeof(charTableDim.y));
+	charsetOUT.write(reinterpret_cast<const char*>(masks.data()), masks.size() * sizeof(unsigned int));
+}
+
+void Charset::RasterizeChar(unsigned char index, Color* pTarget, unsigned int pitch, const Color& color, const Color* pTexture, unsigned int scale) const
+{
+	const unsigned int scaledWidth = characterWidth * scale;
+	const unsigned int simdWidth = characterWidth & ~3u;
+	unsigned int colorBits;
+	memcpy(&colorBits, &color, sizeof(Color));
+	const __m128i colorSpan = _mm_set1_epi32((int)colorBits);
+	const __m128i bitSelect = _mm_set_epi32(8, 4, 2, 1);
+	for (unsigned int y = 0u; y < characterHeight; ++y)
+	{
+		const unsigned int* pMaskRow = &masks[(index * characterHeight + y) * maskPitch];
+		const Color* pTexRow = pTexture ? &pTexture[y * characterWidth] : nullptr;
+		Color* pRow = &pTarget[y * scale * pitch];
+		for (unsigned int x = 0u; x < simdWidth; x += 4u)
+		{
+			const __m128i bits = _mm_set1_epi32((int)((pMaskRow[x / 32u] >> (x % 32u)) & 0xFu));
+			const __m128i mask = _mm_cmpeq_epi32(_mm_and_si128(bits, bitSelect), bitSelect);
+			const __m128i src = pTexRow ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(&pTexRow[x])) : colorSpan;
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(&pRow[x]), _mm_and_si128(mask, src));
+		}
+		for (unsigned int x = simdWidth; x < characterWidth; ++x)
+		{
+			const bool isSet = (pMaskRow[x / 32u] >> (x % 32u)) & 1u;
+			pRow[x] = isSet ? (pTexRow ? pTexRow[x] : color) : Colors::Transparent;
+		}
+		if (scale > 1u)
+		{
+			for (unsigned int x = characterWidth; x-- > 0u;)
+			{
+				std::fill_n(&pRow[x * scale], scale, pRow[x]);
+			}
+			for (unsigned int s = 1u; s < scale; ++s)
+			{
+				memcpy(&pRow[s * pitch], pRow, scaledWidth * sizeof(Color));
+			}
+		}
+	}
+}
+
+std::shared_ptr<const Charset> Charset::Get(const std::string& filename, uchar2 char_table_dim, unsigned char start_char)
+{
+	const bool isPrecompiled = filename.length() > 4u && filename.compare(filename.length() - 4u, 4u, ".ffc") == 0;
+	const std::string key = isPrecompiled ? filename :
+		filename + '|' + std::to_string(char_table_dim.x) + 'x' + std::to_string(char_table_dim.y) + '|' + std::to_string(start_char);
+	std::lock_guard<std::mutex> lock(registryMutex);
+	auto it = registry.find(key);
+	if (it == registry.end())
+	{
+		std::shared_ptr<const Charset> pCharset = isPrecompiled ?
+			std::make_shared<Charset>(filename.c_str()) :
+			std::make_shared<Charset>(Image(filename.c_str()), char_table_dim, start_char);
+		it = registry.emplace(key, std::move(pCharset)).first;
+	}
+	return it->second;
+}
+
+void Charset::Register(const std::string& name, std::shared_ptr<const Charset> charset)
+{
+	assert(charset);
+	std::lock_guard<std::mutex> lock(registryMutex);
+	registry[name] = std::move(charset);
+}
+
+void Charset::ClearRegistry()
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+	registry.clear();
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "Image.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+class Charset
+{
+private:
+	static constexpr unsigned int FileVersion = 1u;
+	static std::mutex registryMutex;
+	static std::unordered_map<std::string, std::shared_ptr<const Charset>> registry;
+	unsigned char characterWidth = 0u;
+	unsigned char characterHeight = 0u;
+	unsigned char startChar = 0u;
+	uchar2 charTableDim = { 0u,0u };
+	unsigned int maskPitch = 0u;
+	std::vector<unsigned int> masks;
+public:
+	Charset() = delete;
+	Charset(const Charset& charset) = delete;
+	Charset& operator =(const Charset& charset) = delete;
+	Charset(const Image& charset, uchar2 char_table_dim, unsigned char start_char);
+	Charset(const char* precompiled_filename);
+	const unsigned char& GetCharacterWidth() const;
+	const unsigned char& GetCharacterHeight() const;
+	const unsigned char& GetStartChar() const;
+	const uchar2& GetCharTableDim() const;
+	unsigned int GetCharCount() const;
+	bool HasChar(unsigned char chr) const;
+	bool IsPixelSet(unsigned char index, unsigned int x, unsigned int y) const;
+	void Save(const char* filename) const;
+	void RasterizeChar(unsigned char index, Color* pTarget, unsigned int pitch, const Color& color, const Color* pTexture, unsigned int scale) const;
+public:
+	static std::shared_ptr<const Charset> Get(const std::string& filename, uchar2 char_table_dim = { 16u,6u }, unsigned char start_char = 32u);
+	static void Register(const std::string& name, std::shared_ptr<const Charset> charset);
+	static void ClearRegistry();
+};
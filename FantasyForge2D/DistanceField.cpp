@@ -0,0 +1,227 @@
+#include "DistanceField.h"
+#include <algorithm>
+#include <assert.h>
+
+static constexpr float EDTInfinity = 1e20f;
+
+static Color BlendColors(const Color& dst, const Color& src, float alpha)
+{
+	const float inv = 1.0f - alpha;
+	return Color(
+		(unsigned int)((float)dst.GetR() * inv + (float)src.GetR() * alpha),
+		(unsigned int)((float)dst.GetG() * inv + (float)src.GetG() * alpha),
+		(unsigned int)((float)dst.GetB() * inv + (float)src.GetB() * alpha),
+		(unsigned int)std::max((float)dst.GetA(), (float)src.GetA() * alpha)
+	);
+}
+
+DistanceField::DistanceField(const std::vector<unsigned char>& inside_mask, unsigned int width, unsigned int height, float spread)
+	:
+	width(width),
+	height(height),
+	spread(spread),
+	distances(width * height)
+{
+	assert(width > 0u && height > 0u);
+	assert(spread > 0.0f);
+	std::vector<float> toInside(width * height);
+	std::vector<float> toOutside(width * height);
+	for (unsigned int i = 0u; i < width * height; ++i)
+	{
+		toInside[i] = inside_mask[i] ? 0.0f : EDTInfinity;
+		toOutside[i] = inside_mask[i] ? EDTInfinity : 0.0f;
+	}
+	Transform2D(toInside, width, height);
+	Transform2D(toOutside, width, height);
+	for (unsigned int i = 0u; i < width * height; ++i)
+	{
+		const float d = inside_mask[i] ? 0.5f - sqrtf(toOutside[i]) : sqrtf(toInside[i]) - 0.5f;
+		distances[i] = std::clamp(d, -spread, spread);
+	}
+}
+
+void DistanceField::Transform1D(const float* f, float* d, int* v, float* z, unsigned int n)
+{
+	int k = 0;
+	v[0] = 0;
+	z[0] = -EDTInfinity;
+	z[1] = EDTInfinity;
+	for (int q = 1; q < (int)n; ++q)
+	{
+		float s = ((f[q] + (float)(q * q)) - (f[v[k]] + (float)(v[k] * v[k]))) / (float)(2 * q - 2 * v[k]);
+		while (s <= z[k])
+		{
+			--k;
+			s = ((f[q] + (float)(q * q)) - (f[v[k]] + (float)(v[k] * v[k]))) / (float)(2 * q - 2 * v[k]);
+		}
+		++k;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = EDTInfinity;
+	}
+	k = 0;
+	for (int q = 0; q < (int)n; ++q)
+	{
+		while (z[k + 1] < (float)q)
+		{
+			++k;
+		}
+		d[q] = (float)((q - v[k]) * (q - v[k])) + f[v[k]];
+	}
+}
+
+void DistanceField::Transform2D(std::vector<float>& grid, unsigned int width, unsigned int height)
+{
+	const unsigned int n = std::max(width, height);
+	std::vector<float> f(n);
+	std::vector<float> d(n);
+	std::vector<int> v(n);
+	std::vector<float> z(n + 1u);
+	for (unsigned int x = 0u; x < width; ++x)
+	{
+		for (unsigned int y = 0u; y < height; ++y)
+		{
+			f[y] = grid[y * width + x];
+		}
+		Transform1D(f.data(), d.data(), v.data(), z.data(), height);
+		for (unsigned int y = 0u; y < height; ++y)
+		{
+			grid[y * width + x] = d[y];
+		}
+	}
+	for (unsigned int y = 0u; y < height; ++y)
+	{
+		Transform1D(&grid[y * width], d.data(), v.data(), z.data(), width);
+		std::copy(d.begin(), d.begin() + width, grid.begin() + y * width);
+	}
+}
+
+const unsigned int& DistanceField::GetWidth() const
+{
+	return width;
+}
+
+const unsigned int& DistanceField::GetHeight() const
+{
+	return height;
+}
+
+const float& DistanceField::GetSpread() const
+{
+	return spread;
+}
+
+float DistanceField::GetDistance(unsigned int x, unsigned int y) const
+{
+	assert(x < width && y < height);
+	return distances[y * width + x];
+}
+
+float DistanceField::Sample(float x, float y) const
+{
+	const float cx = std::clamp(x, 0.0f, (float)(width - 1u));
+	const float cy = std::clamp(y, 0.0f, (float)(height - 1u));
+	const unsigned int x0 = (unsigned int)cx;
+	const unsigned int y0 = (unsigned int)cy;
+	const unsigned int x1 = std::min(x0 + 1u, width - 1u);
+	const unsigned int y1 = std::min(y0 + 1u, height - 1u);
+	const float tx = cx - (float)x0;
+	const float ty = cy - (float)y0;
+	const float top = distances[y0 * width + x0] * (1.0f - tx) + distances[y0 * width + x1] * tx;
+	const float bottom = distances[y1 * width + x0] * (1.0f - tx) + distances[y1 * width + x1] * tx;
+	const float d = top * (1.0f - ty) + bottom * ty;
+	const float outside = std::max(std::max(-x, x - (float)(width - 1u)), std::max(-y, y - (float)(height - 1u)));
+	return outside > 0.0f ? std::max(d, d + outside) : d;
+}
+
+Image DistanceField::ToImage() const
+{
+	Image image(width, height);
+	for (unsigned int y = 0u; y < height; ++y)
+	{
+		for (unsigned int x = 0u; x < width; ++x)
+		{
+			const unsigned int value = (unsigned int)(127.5f - distances[y * width + x] / spread * 127.5f);
+			image.SetPixel(x, y, Color(value, value, value));
+		}
+	}
+	return image;
+}
+
+void DistanceField::Draw(Graphics& gfx, int X, int Y, float scale, const Style& style, unsigned int layer) const
+{
+	assert(scale > 0.0f);
+	assert(style.outlineWidth >= 0.0f && style.glowRadius >= 0.0f);
+	const int layerWidth = (int)gfx.GetWidth(layer);
+	const int layerHeight = (int)gfx.GetHeight(layer);
+	const float margin = std::max(style.outlineWidth, style.glowRadius) * scale;
+	const int startX = std::max(X - (int)ceilf(margin), 0);
+	const int startY = std::max(Y - (int)ceilf(margin), 0);
+	const int endX = std::min(X + (int)ceilf((float)width * scale + margin), layerWidth);
+	const int endY = std::min(Y + (int)ceilf((float)height * scale + margin), layerHeight);
+	const float invScale = 1.0f / scale;
+	const float outlineEdge = style.outlineWidth;
+	const float glowEdge = std::max(style.glowRadius, outlineEdge);
+	std::vector<Color>& pxlMap = gfx.GetPixelMap(layer);
+	for (int py = startY; py < endY; ++py)
+	{
+		const float fy = ((float)(py - Y) + 0.5f) * invScale - 0.5f;
+		for (int px = startX; px < endX; ++px)
+		{
+			const float fx = ((float)(px - X) + 0.5f) * invScale - 0.5f;
+			const float d = Sample(fx, fy);
+			if (d >= glowEdge + invScale)
+			{
+				continue;
+			}
+			Color& dst = pxlMap[py * layerWidth + px];
+			if (style.glowRadius > outlineEdge && d > outlineEdge)
+			{
+				const float glow = 1.0f - (d - outlineEdge) / (style.glowRadius - outlineEdge);
+				dst = BlendColors(dst, style.glowColor, std::clamp(glow * glow, 0.0f, 1.0f) * style.glowColor.GetAn());
+			}
+			if (outlineEdge > 0.0f)
+			{
+				const float coverage = std::clamp((outlineEdge - d) * scale + 0.5f, 0.0f, 1.0f);
+				if (coverage > 0.0f)
+				{
+					dst = BlendColors(dst, style.outlineColor, coverage);
+				}
+			}
+			const float coverage = std::clamp(0.5f - d * scale, 0.0f, 1.0f);
+			if (coverage > 0.0f)
+			{
+				dst = BlendColors(dst, style.fillColor, coverage);
+			}
+		}
+	}
+}
+
+DistanceField DistanceField::FromImage(const Image& image, float spread, unsigned char alpha_threshold)
+{
+	const unsigned int nPixels = image.GetWidth() * image.GetHeight();
+	std::vector<unsigned char> inside(nPixels);
+	const Color* pImage = image.GetPtrToImage();
+	for (unsigned int i = 0u; i < nPixels; ++i)
+	{
+		inside[i] = pImage[i].GetA() >= alpha_threshold;
+	}
+	return DistanceField(inside, image.GetWidth(), image.GetHeight(), spread);
+}
+
+DistanceField DistanceField::FromCharset(const Charset& charset, unsigned char chr, float spread)
+{
+	assert(charset.HasChar(chr));
+	const unsigned char index = chr - charset.GetStartChar();
+	const unsigned int charWidth = charset.GetCharacterWidth();
+	const unsigned int charHeight = charset.GetCharacterHeight();
+	std::vector<unsigned char> inside(charWidth * charHeight);
+	for (unsigned int y = 0u; y < charHeight; ++y)
+	{
+		for (unsigned int x = 0u; x < charWidth; ++x)
+		{
+			inside[y * charWidth + x] = charset.IsPixelSet(index, x, y);
+		}
+	}
+	return DistanceField(inside, charWidth, charHeight, spread);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "Image.h"
+#include "Charset.h"
+#include <vector>
+
+class DistanceField
+{
+public:
+	struct Style
+	{
+		Color fillColor = Colors::White;
+		float outlineWidth = 0.0f;
+		Color outlineColor = Colors::Black;
+		float glowRadius = 0.0f;
+		Color glowColor = Colors::White;
+	};
+private:
+	unsigned int width = 0u;
+	unsigned int height = 0u;
+	float spread = 0.0f;
+	std::vector<float> distances;
+private:
+	DistanceField(const std::vector<unsigned char>& inside_mask, unsigned int width, unsigned int height, float spread);
+	static void Transform1D(const float* f, float* d, int* v, float* z, unsigned int n);
+	static void Transform2D(std::vector<float>& grid, unsigned int width, unsigned int height);
+public:
+	DistanceField() = default;
+	const unsigned int& GetWidth() const;
+	const unsigned int& GetHeight() const;
+	const float& GetSpread() const;
+	float GetDistance(unsigned int x, unsigned int y) const;
+	float Sample(float x, float y) const;
+	Image ToImage() const;
+	void Draw(Graphics& gfx, int X, int Y, float scale, const Style& style, unsigned int layer = 0u) const;
+public:
+	static DistanceField FromImage(const Image& image, float spread, unsigned char alpha_threshold = 128u);
+	static DistanceField FromCharset(const Charset& charset, unsigned char chr, float spread);
+};
@@ -1,24 +1,77 @@
 #include "Engine.h"
+#include "SoundSystem.h"
+#include "InputReplay.h"
+#include <algorithm>
 
-Engine::Engine()
+Engine::Engine(bool headless)
 	:
-	wnd(1024u, 576u, "FantasyForge2D", { { 1024u,576u } }),
+	wnd(1024u, 576u, "FantasyForge2D", { { 1024u,576u } }, !headless),
 	kbd(wnd.kbd),
 	mouse(wnd.mouse),
 	gfx(wnd.gfx()),
-	AppClock()
+	AppClock(),
+	FrameClock()
 {
-
+	SoundSystem::SetHeadless(headless);
+	if (headless)
+	{
+		gfx.DisableVSync();
+	}
 }
 
 void Engine::Go()
+{
+	dt = FrameClock.Mark();
+	if (pRecorder)
+	{
+		pRecorder->CommitFrame(dt);
+	}
+	Frame();
+}
+
+void Engine::Frame()
 {
 	gfx.NewFrame();
+	SoundSystem::Get().Update(dt);
 	UpdateModel();
 	ComposeFrame();
 	gfx.EndFrame();
 }
 
+void Engine::StartRecording(const std::string& log_file)
+{
+	pRecorder.reset();
+	pRecorder = std::make_unique<InputRecorder>(kbd, mouse, log_file);
+}
+
+void Engine::StopRecording()
+{
+	pRecorder.reset();
+}
+
+Engine::ReplayStats Engine::Replay(const std::string& log_file)
+{
+	StopRecording();
+	InputReplay replay(log_file);
+	kbd.ClearKeystates();
+	kbd.EmptyEventQueue();
+	kbd.EmptyCharacterBuffer();
+	mouse.Reset();
+	// the model only ever sees recorded input and recorded frame times, so the simulation replays exactly
+	ReplayStats stats = { 0u, 0.0f, 0.0f };
+	Clock frameTimer;
+	while (replay.NextFrame(kbd, mouse, dt))
+	{
+		frameTimer.Mark();
+		Frame();
+		const float frameTime = frameTimer.Mark();
+		stats.totalTime += frameTime;
+		stats.worstFrameTime = std::max(stats.worstFrameTime, frameTime);
+		++stats.nFrames;
+	}
+	return stats;
+}
+
 void Engine::UpdateModel()
 {
 
@@ -1,23 +1,38 @@
 #pragma once
 #include "Window.h"
 #include "Clock.h"
+#include "InputRecorder.h"
 
 class Engine
 {
+public:
+	struct ReplayStats
+	{
+		unsigned int nFrames;
+		float totalTime;
+		float worstFrameTime;
+	};
 private:
 	Window wnd;
 	Keyboard& kbd;
 	Mouse& mouse;
 	Graphics& gfx;
 	const Clock AppClock;
+	Clock FrameClock;
+	float dt = 0.0f;
+	std::unique_ptr<InputRecorder> pRecorder = nullptr;
 private:
+	void Frame();
 	void UpdateModel();
 	void ComposeFrame();
 public:
-	Engine();
+	Engine(bool headless = false);
 	Engine(const Engine& engine) = delete;
 	Engine operator =(const Engine& engine) = delete;
 	void Go();
+	void StartRecording(const std::string& log_file);
+	void StopRecording();
+	ReplayStats Replay(const std::string& log_file);
 };
 
 
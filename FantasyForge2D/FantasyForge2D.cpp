@@ -1,12 +1,35 @@
 #include "Engine.h"
 #include "Shaders.h"
+#include <fstream>
 
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nShowCmd)
 {
 	try
 	{
 		PSS(); VSS();
+		// -record <log> captures input and frame times, -replay <log> [report] plays one back headless as fast as possible
+		std::istringstream args(lpCmdLine);
+		std::string mode, logFile, reportFile;
+		args >> mode >> logFile >> reportFile;
+		if (mode == "-replay")
+		{
+			Engine FantasyForge2D(true);
+			const Engine::ReplayStats stats = FantasyForge2D.Replay(logFile);
+			if (!reportFile.empty())
+			{
+				std::ofstream reportOUT(reportFile);
+				reportOUT << "frames " << stats.nFrames << std::endl
+					<< "total_ms " << stats.totalTime * 1000.0f << std::endl
+					<< "mean_ms " << (stats.nFrames ? stats.totalTime * 1000.0f / float(stats.nFrames) : 0.0f) << std::endl
+					<< "worst_ms " << stats.worstFrameTime * 1000.0f << std::endl;
+			}
+			return 0;
+		}
 		Engine FantasyForge2D;
+		if (mode == "-record")
+		{
+			FantasyForge2D.StartRecording(logFile);
+		}
 		while (true)
 		{
 			if (const auto exit_code = Window::ProcessMessages())
@@ -0,0 +1,331 @@
+#include "Font.h"
+#include "BaseException.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <assert.h>
+
+Font::Font(Image atlas, unsigned int line_height, unsigned int baseline)
+	:
+	atlas(atlas),
+	isAlphaMasked(false),
+	lineHeight(line_height),
+	baseline(baseline)
+{
+	assert(line_height > 0u);
+	const Color* pAtlas = this->atlas.GetPtrToImage();
+	const unsigned int nPixels = this->atlas.GetWidth() * this->atlas.GetHeight();
+	for (unsigned int i = 0u; i < nPixels && !isAlphaMasked; ++i)
+	{
+		isAlphaMasked = pAtlas[i].GetA() < 255u;
+	}
+}
+
+Font::Font(const char* atlas_filename, const char* metrics_filename)
+	:
+	Font(Image(atlas_filename), 1u, 0u)
+{
+	std::ifstream metricsIN{ metrics_filename };
+	if (metricsIN.fail())
+	{
+		throw EXCPT_NOTE("Font metrics file not found! Check directory and/or file name spelling and retry.");
+	}
+	std::string line;
+	while (std::getline(metricsIN, line))
+	{
+		std::istringstream lineIN(line);
+		std::string tag;
+		lineIN >> tag;
+		std::unordered_map<std::string, int> values;
+		std::string token;
+		while (lineIN >> token)
+		{
+			const size_t eq = token.find('=');
+			if (eq != std::string::npos && eq + 1u < token.length() && token[eq + 1u] != '"')
+			{
+				values[token.substr(0u, eq)] = std::stoi(token.substr(eq + 1u));
+			}
+		}
+		if (tag == "common")
+		{
+			if (!values.count("lineHeight") || values["lineHeight"] <= 0)
+			{
+				throw EXCPT_NOTE("Font metrics file has no valid lineHeight! Check the common line and retry.");
+			}
+			lineHeight = (unsigned int)values["lineHeight"];
+			baseline = (unsigned int)values["base"];
+		}
+		else if (tag == "char")
+		{
+			const int id = values["id"];
+			if (id < 0 || id > 255)
+			{
+				continue;
+			}
+			const uRect rect({ (unsigned int)values["x"],(unsigned int)values["y"] }, (unsigned int)values["width"], (unsigned int)values["height"]);
+			if (rect.pos.x + rect.width > atlas.GetWidth() || rect.pos.y + rect.height > atlas.GetHeight())
+			{
+				throw EXCPT_NOTE("Font glyph lies outside of the atlas image! Check the metrics file against the atlas and retry.");
+			}
+			AddGlyph((unsigned char)id, { rect,values["xoffset"],values["yoffset"],values["xadvance"] });
+		}
+		else if (tag == "kerning")
+		{
+			const int first = values["first"];
+			const int second = values["second"];
+			if (first >= 0 && first <= 255 && second >= 0 && second <= 255)
+			{
+				SetKerning((unsigned char)first, (unsigned char)second, values["amount"]);
+			}
+		}
+	}
+}
+
+bool Font::IsCovered(const Color& pxl) const
+{
+	return isAlphaMasked ? pxl.GetA() != 0u : pxl != Colors::White;
+}
+
+void Font::AddGlyph(unsigned char chr, const Glyph& glyph)
+{
+	assert(glyph.atlasRect.pos.x + glyph.atlasRect.width <= atlas.GetWidth());
+	assert(glyph.atlasRect.pos.y + glyph.atlasRect.height <= atlas.GetHeight());
+	GlyphEntry& entry = glyphs[chr];
+	if (entry.isPresent)
+	{
+		spans.erase(spans.begin() + entry.firstSpan, spans.begin() + entry.firstSpan + entry.nSpans);
+		for (GlyphEntry& other : glyphs)
+		{
+			if (other.isPresent && other.firstSpan > entry.firstSpan)
+			{
+				other.firstSpan -= entry.nSpans;
+			}
+		}
+	}
+	entry.glyph = glyph;
+	entry.firstSpan = (unsigned int)spans.size();
+	entry.isPresent = true;
+	for (unsigned int y = 0u; y < glyph.atlasRect.height; ++y)
+	{
+		unsigned int x = 0u;
+		while (x < glyph.atlasRect.width)
+		{
+			if (!IsCovered(atlas.GetPixel(glyph.atlasRect.pos.x + x, glyph.atlasRect.pos.y + y)))
+			{
+				++x;
+				continue;
+			}
+			const unsigned int start = x;
+			while (x < glyph.atlasRect.width && IsCovered(atlas.GetPixel(glyph.atlasRect.pos.x + x, glyph.atlasRect.pos.y + y)))
+			{
+				++x;
+			}
+			spans.push_back({ (unsigned short)start,(unsigned short)y,(unsigned short)(x - start) });
+		}
+	}
+	entry.nSpans = (unsigned int)spans.size() - entry.firstSpan;
+	layoutCache.clear();
+}
+
+bool Font::HasGlyph(unsigned char chr) const
+{
+	return glyphs[chr].isPresent;
+}
+
+const Font::Glyph& Font::GetGlyph(unsigned char chr) const
+{
+	assert(glyphs[chr].isPresent);
+	return glyphs[chr].glyph;
+}
+
+void Font::SetKerning(unsigned char first, unsigned char second, int amount)
+{
+	const unsigned short key = (unsigned short)((first << 8) | second);
+	if (amount == 0)
+	{
+		kerning.erase(key);
+	}
+	else
+	{
+		kerning[key] = amount;
+	}
+	layoutCache.clear();
+}
+
+int Font::GetKerning(unsigned char first, unsigned char second) const
+{
+	if (kerning.empty())
+	{
+		return 0;
+	}
+	const auto it = kerning.find((unsigned short)((first << 8) | second));
+	return it != kerning.end() ? it->second : 0;
+}
+
+const unsigned int& Font::GetLineHeight() const
+{
+	return lineHeight;
+}
+
+const unsigned int& Font::GetBaseline() const
+{
+	return baseline;
+}
+
+const Image& Font::GetAtlas() const
+{
+	return atlas;
+}
+
+unsigned int Font::MeasureWord(const std::string& text, size_t first, size_t last) const
+{
+	int width = 0;
+	unsigned char prev = 0u;
+	for (size_t i = first; i < last; ++i)
+	{
+		const unsigned char chr = (unsigned char)text[i];
+		if (glyphs[chr].isPresent)
+		{
+			width += glyphs[chr].glyph.advance + (prev ? GetKerning(prev, chr) : 0);
+			prev = chr;
+		}
+	}
+	return (unsigned int)std::max(width, 0);
+}
+
+Font::TextLayout Font::ComputeLayout(const std::string& text, unsigned int max_width) const
+{
+	TextLayout layout;
+	layout.glyphs.reserve(text.length());
+	layout.nLines = 1u;
+	int penX = 0;
+	int penY = 0;
+	int lineEnd = 0;
+	unsigned char prev = 0u;
+	auto breakLine = [&]()
+	{
+		layout.width = std::max(layout.width, (unsigned int)std::max(lineEnd, 0));
+		penX = 0;
+		lineEnd = 0;
+		penY += (int)lineHeight;
+		prev = 0u;
+		++layout.nLines;
+	};
+	size_t i = 0u;
+	while (i < text.length())
+	{
+		const unsigned char chr = (unsigned char)text[i];
+		if (chr == '\n')
+		{
+			breakLine();
+			++i;
+			continue;
+		}
+		if (chr == ' ')
+		{
+			if (glyphs[chr].isPresent)
+			{
+				penX += glyphs[chr].glyph.advance + (prev ? GetKerning(prev, chr) : 0);
+				prev = chr;
+			}
+			++i;
+			continue;
+		}
+		size_t wordEnd = i;
+		while (wordEnd < text.length() && text[wordEnd] != ' ' && text[wordEnd] != '\n')
+		{
+			++wordEnd;
+		}
+		if (max_width && penX > 0 && penX + (int)MeasureWord(text, i, wordEnd) > (int)max_width)
+		{
+			breakLine();
+		}
+		for (; i < wordEnd; ++i)
+		{
+			const unsigned char c = (unsigned char)text[i];
+			if (!glyphs[c].isPresent)
+			{
+				continue;
+			}
+			const Glyph& glyph = glyphs[c].glyph;
+			if (max_width && penX > 0 && penX + glyph.advance > (int)max_width)
+			{
+				breakLine();
+			}
+			penX += prev ? GetKerning(prev, c) : 0;
+			layout.glyphs.push_back({ { penX + glyph.xOffset,penY + glyph.yOffset },c });
+			lineEnd = std::max(lineEnd, penX + std::max(glyph.advance, glyph.xOffset + (int)glyph.atlasRect.width));
+			penX += glyph.advance;
+			prev = c;
+		}
+	}
+	layout.width = std::max(layout.width, (unsigned int)std::max(lineEnd, 0));
+	layout.height = layout.nLines * lineHeight;
+	return layout;
+}
+
+std::shared_ptr<const Font::TextLayout> Font::Layout(const std::string& text, unsigned int max_width) const
+{
+	std::string key = std::to_string(max_width);
+	key += '|';
+	key += text;
+	auto it = layoutCache.find(key);
+	if (it == layoutCache.end())
+	{
+		if (layoutCache.size() >= MaxCachedLayouts)
+		{
+			layoutCache.clear();
+		}
+		it = layoutCache.emplace(std::move(key), std::make_shared<const TextLayout>(ComputeLayout(text, max_width))).first;
+	}
+	return it->second;
+}
+
+vec2u Font::Measure(const std::string& text, unsigned int max_width) const
+{
+	const std::shared_ptr<const TextLayout> pLayout = Layout(text, max_width);
+	return { pLayout->width,pLayout->height };
+}
+
+void Font::ClearLayoutCache()
+{
+	layoutCache.clear();
+}
+
+void Font::Draw(Graphics& gfx, const TextLayout& layout, int X, int Y, const Color& color, unsigned int layer) const
+{
+	const int layerWidth = (int)gfx.GetWidth(layer);
+	const int layerHeight = (int)gfx.GetHeight(layer);
+	Color* pPaper = gfx.GetPixelMap(layer).data();
+	for (const PlacedGlyph& pg : layout.glyphs)
+	{
+		const GlyphEntry& entry = glyphs[pg.chr];
+		const int glyphX = X + pg.pos.x;
+		const int glyphY = Y + pg.pos.y;
+		if (glyphX >= layerWidth || glyphY >= layerHeight ||
+			glyphX + (int)entry.glyph.atlasRect.width <= 0 || glyphY + (int)entry.glyph.atlasRect.height <= 0)
+		{
+			continue;
+		}
+		for (unsigned int s = entry.firstSpan; s < entry.firstSpan + entry.nSpans; ++s)
+		{
+			const Span& span = spans[s];
+			const int y = glyphY + span.y;
+			if (y < 0 || y >= layerHeight)
+			{
+				continue;
+			}
+			const int x0 = std::max(glyphX + span.x, 0);
+			const int x1 = std::min(glyphX + span.x + span.length, layerWidth);
+			if (x0 < x1)
+			{
+				std::fill_n(&pPaper[y * layerWidth + x0], x1 - x0, color);
+			}
+		}
+	}
+}
+
+void Font::Draw(Graphics& gfx, const std::string& text, int X, int Y, const Color& color, unsigned int max_width, unsigned int layer) const
+{
+	Draw(gfx, *Layout(text, max_width), X, Y, color, layer);
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include "Image.h"
+#include "Rect.h"
+#include <array>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+class Font
+{
+public:
+	struct Glyph
+	{
+		uRect atlasRect;
+		int xOffset;
+		int yOffset;
+		int advance;
+	};
+	struct PlacedGlyph
+	{
+		vec2i pos;
+		unsigned char chr;
+	};
+	struct TextLayout
+	{
+		std::vector<PlacedGlyph> glyphs;
+		unsigned int width = 0u;
+		unsigned int height = 0u;
+		unsigned int nLines = 0u;
+	};
+private:
+	struct Span
+	{
+		unsigned short x;
+		unsigned short y;
+		unsigned short length;
+	};
+	struct GlyphEntry
+	{
+		Glyph glyph;
+		unsigned int firstSpan = 0u;
+		unsigned int nSpans = 0u;
+		bool isPresent = false;
+	};
+private:
+	static constexpr unsigned int MaxCachedLayouts = 1024u;
+	Image atlas;
+	bool isAlphaMasked;
+	unsigned int lineHeight;
+	unsigned int baseline;
+	std::array<GlyphEntry, 256u> glyphs;
+	std::vector<Span> spans;
+	std::unordered_map<unsigned short, int> kerning;
+	mutable std::unordered_map<std::string, std::shared_ptr<const TextLayout>> layoutCache;
+private:
+	bool IsCovered(const Color& pxl) const;
+	TextLayout ComputeLayout(const std::string& text, unsigned int max_width) const;
+	unsigned int MeasureWord(const std::string& text, size_t first, size_t last) const;
+public:
+	Font() = delete;
+	Font(Image atlas, unsigned int line_height, unsigned int baseline);
+	Font(const char* atlas_filename, const char* metrics_filename);
+	void AddGlyph(unsigned char chr, const Glyph& glyph);
+	bool HasGlyph(unsigned char chr) const;
+	const Glyph& GetGlyph(unsigned char chr) const;
+	void SetKerning(unsigned char first, unsigned char second, int amount);
+	int GetKerning(unsigned char first, unsigned char second) const;
+	const unsigned int& GetLineHeight() const;
+	const unsigned int& GetBaseline() const;
+	const Image& GetAtlas() const;
+	std::shared_ptr<const TextLayout> Layout(const std::string& text, unsigned int max_width = 0u) const;
+	vec2u Measure(const std::string& text, unsigned int max_width = 0u) const;
+	void ClearLayoutCache();
+	void Draw(Graphics& gfx, const TextLayout& layout, int X, int Y, const Color& color, unsigned int layer = 0u) const;
+	void Draw(Graphics& gfx, const std::string& text, int X, int Y, const Color& color, unsigned int max_width = 0u, unsigned int layer = 0u) const;
+};
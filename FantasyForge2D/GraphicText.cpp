@@ -3,51 +3,23 @@
 
 GraphicText::GraphicText(Graphics& gfx, unsigned int layer)
 	:
-	gfx(gfx),
-	paper(layer),
-	CharacterWidth(16u),
-	CharacterHeight(16u),
-	startChar(32u),
-	charTableDim({ 16u,6u }),
-	cursorLimit({ gfx.GetWidth(paper) / CharacterWidth, gfx.GetHeight(paper) / CharacterHeight }),
-	tlMargins({ 0u,0u }),
-	brMargins({ 0u,0u }),
-	Cursor({ 0u,0u }),
-	TextColor(Colors::White),
-	TextScale(1u),
-	autoCursor(true),
-	lineFeed(true),
-	lineSpacing(1u),
-	TextTexture(),
-	isUsingTexture(TextTexture)
-{
-	Image defaultCharset = Image("charsets\\default.bmp");
-	CharBitmaps.resize(charTableDim.x * charTableDim.y);
-	for (std::vector<bool>& cb : CharBitmaps)
-	{
-		cb.resize(CharacterWidth * CharacterHeight);
-	}
-	for (unsigned int i = 0u; i < CharBitmaps.size(); ++i)
-	{
-		Image charImage = defaultCharset.Cropped(CharacterWidth, CharacterHeight, (i % charTableDim.x) * CharacterWidth, (i / charTableDim.x) * CharacterHeight);
-		for (unsigned int y = 0u; y < CharacterHeight; ++y)
-		{
-			for (unsigned int x = 0u; x < CharacterWidth; ++x)
-			{
-				CharBitmaps[i][y * CharacterWidth + x] = (charImage.GetPixel(x, y) != Colors::White);
-			}
-		}
-	} 
-}
+	GraphicText(gfx, layer, Charset::Get("charsets\\default.bmp", { 16u,6u }, 32u))
+{}
 
 GraphicText::GraphicText(Graphics& gfx, unsigned int layer, Image charset, uchar2 charTableDim, unsigned char startChar, uint2 cursor_pos, Color txtColor, unsigned int txtScale, bool doubleSpaced, bool auto_cursor, bool line_feed, uint2 tl_margins, uint2 br_margins, std::optional<Image> txtTexture)
+	:
+	GraphicText(gfx, layer, std::make_shared<Charset>(charset, charTableDim, startChar), cursor_pos, txtColor, txtScale, doubleSpaced, auto_cursor, line_feed, tl_margins, br_margins, txtTexture)
+{}
+
+GraphicText::GraphicText(Graphics& gfx, unsigned int layer, std::shared_ptr<const Charset> charset, uint2 cursor_pos, Color txtColor, unsigned int txtScale, bool doubleSpaced, bool auto_cursor, bool line_feed, uint2 tl_margins, uint2 br_margins, std::optional<Image> txtTexture)
 	:
 	gfx(gfx),
 	paper(layer),
-	CharacterWidth(charset.GetWidth() / charTableDim.x),
-	CharacterHeight(charset.GetHeight() / charTableDim.y),
-	startChar(startChar),
-	charTableDim(charTableDim),
+	pCharset(charset),
+	CharacterWidth(charset->GetCharacterWidth()),
+	CharacterHeight(charset->GetCharacterHeight()),
+	startChar(charset->GetStartChar()),
+	charTableDim(charset->GetCharTableDim()),
 	cursorLimit({ gfx.GetWidth(paper) / (CharacterWidth * txtScale),gfx.GetHeight(paper) / (CharacterHeight * txtScale) }),
 	tlMargins(tl_margins),
 	brMargins(br_margins),
@@ -71,22 +43,16 @@ GraphicText::GraphicText(Graphics& gfx, unsigned int layer, Image charset, uchar
 		assert(TextTexture->GetWidth() == CharacterWidth);
 		assert(TextTexture->GetHeight() == CharacterHeight);
 	}
-	CharBitmaps.resize(charTableDim.x * charTableDim.y);
-	for (std::vector<bool>& cb : CharBitmaps)
-	{
-		cb.resize(CharacterWidth * CharacterHeight);
-	}
-	for (unsigned int i = 0u; i < CharBitmaps.size(); ++i)
-	{
-		Image charImage = charset.Cropped(CharacterWidth, CharacterHeight, (i % charTableDim.x) * CharacterWidth, (i / charTableDim.y) * CharacterHeight);
-		for (unsigned int y = 0u; y < CharacterHeight; ++y)
-		{
-			for (unsigned int x = 0u; x < CharacterWidth; ++x)
-			{
-				CharBitmaps[i][y * CharacterWidth + x] = (charImage.GetPixel(x, y) != Colors::White);
-			}
-		}
-	}
+}
+
+void GraphicText::RasterizeChar(unsigned char index, Color* pTarget, unsigned int pitch, const Color& color, const Color* pTexture, unsigned int scale) const
+{
+	pCharset->RasterizeChar(index, pTarget, pitch, color, pTexture, scale);
+}
+
+const std::shared_ptr<const Charset>& GraphicText::GetCharset() const
+{
+	return pCharset;
 }
 
 void GraphicText::SetTopLeftMargins(const uint2& tl_margins)
@@ -349,23 +315,7 @@ void GraphicText::Write(std::string text)
 		text[i] -= startChar;
 		Y = Cursor.y * (CharacterHeight * TextScale);
 		X = Cursor.x * (CharacterWidth * TextScale);
-		for (unsigned int y = 0u; y < CharacterHeight * TextScale; ++y)
-		{
-			const unsigned int yPxl = (Y + y) * gfx.GetWidth(paper);
-			const unsigned int yBit = (y / TextScale) * CharacterWidth;
-			for (unsigned int x = 0u; x < CharacterWidth * TextScale; ++x)
-			{
-				if (isUsingTexture)
-				{
-					const unsigned int xBit = x / TextScale;
-					gfx.GetPixelMap(paper)[yPxl + (X + x)] = (TextTexture->GetPtrToImage()[yBit + xBit] * (float)CharBitmaps[text[i]][yBit + xBit]);
-				}
-				else
-				{
-					gfx.GetPixelMap(paper)[yPxl + (X + x)] = (TextColor * (float)CharBitmaps[text[i]][yBit + (x / TextScale)]);
-				}
-			}
-		}
+		RasterizeChar((unsigned char)text[i], &gfx.GetPixelMap(paper)[Y * gfx.GetWidth(paper) + X], gfx.GetWidth(paper), TextColor, isUsingTexture ? TextTexture->GetPtrToImage() : nullptr, TextScale);
 		if (isBackspace)
 		{
 			continue;
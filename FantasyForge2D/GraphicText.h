@@ -1,5 +1,6 @@
 #pragma once
 #include "Image.h"
+#include "Charset.h"
 #include "Vector.h"
 #include <vector>
 #include <optional>
@@ -9,9 +10,9 @@ class GraphicText
 private:
 	Graphics& gfx;
 	unsigned int paper;
+	std::shared_ptr<const Charset> pCharset;
 	const unsigned char CharacterWidth;
 	const unsigned char CharacterHeight;
-	std::vector<std::vector<bool>> CharBitmaps;
 	const unsigned char startChar;
 	const uchar2 charTableDim;
 	uint2 cursorLimit;
@@ -25,10 +26,14 @@ private:
 	unsigned int lineSpacing;
 	std::optional<Image> TextTexture;
 	bool isUsingTexture;
+private:
+	void RasterizeChar(unsigned char index, Color* pTarget, unsigned int pitch, const Color& color, const Color* pTexture, unsigned int scale) const;
 public:
 	GraphicText() = delete;
 	GraphicText(Graphics& gfx, unsigned int layer = 0u);
 	GraphicText(Graphics& gfx, unsigned int layer, Image charset, uchar2 charTableDim, unsigned char startChar, uint2 cursor_pos = { 0u,0u }, Color txtColor = Colors::White, unsigned int txtScale = 1u, bool double_spaced = false, bool autoCursor = true, bool lineFeed = true, uint2 tl_margins = { 0u,0u }, uint2 br_margins = { 0u,0u }, std::optional<Image> txtTexture = std::optional<Image>());
+	GraphicText(Graphics& gfx, unsigned int layer, std::shared_ptr<const Charset> charset, uint2 cursor_pos = { 0u,0u }, Color txtColor = Colors::White, unsigned int txtScale = 1u, bool double_spaced = false, bool autoCursor = true, bool lineFeed = true, uint2 tl_margins = { 0u,0u }, uint2 br_margins = { 0u,0u }, std::optional<Image> txtTexture = std::optional<Image>());
+	const std::shared_ptr<const Charset>& GetCharset() const;
 	void SetTopLeftMargins(const uint2& tl_margins);
 	void SetBottomRightMargins(const uint2& br_margins);
 	const uint2& GetTopLeftMargins() const;
@@ -207,7 +207,7 @@ void Graphics::EndFrame() const
 	}
 #ifdef _DEBUG
 	HRESULT hr;
-	if (FAILED(hr = pFrameManager->Present(1u, 0u)))
+	if (FAILED(hr = pFrameManager->Present(syncInterval, 0u)))
 	{
 		if (hr == DXGI_ERROR_DEVICE_REMOVED)
 		{
@@ -219,10 +219,20 @@ void Graphics::EndFrame() const
 		}
 	}
 #else
-	pFrameManager->Present(1u, 0u);
+	pFrameManager->Present(syncInterval, 0u);
 #endif
 }
 
+void Graphics::EnableVSync()
+{
+	syncInterval = 1u;
+}
+
+void Graphics::DisableVSync()
+{
+	syncInterval = 0u;
+}
+
 const bool& Graphics::isAutoManaged(unsigned int layer) const
 {
 	return Layers[layer].isAutoManaged;
@@ -693,12 +703,14 @@ const vec2& Graphics::GetScale(unsigned int layer) const
 	return Layers[layer].scale;
 }
 
+Affine2D Graphics::GetTransform(unsigned int layer) const
+{
+	return Affine2D::RotationScalingTranslation(Layers[layer].rotation, Layers[layer].scale, Layers[layer].position);
+}
+
 mat4 Graphics::GetTransformationMatrix(unsigned int layer) const
 {
-	return
-		mat4(mat3::RotationZ(Layers[layer].rotation)) *
-		mat4::Scaling(Layers[layer].scale.x, Layers[layer].scale.y, 1.0f, 1.0f) *
-		mat4::Translation(Layers[layer].position.x, Layers[layer].position.y, 0.0f);
+	return GetTransform(layer).ToMat4();
 }
 
 mat4 Graphics::GetPreTransformMatrix(unsigned int layer) const
@@ -716,18 +728,28 @@ mat4 Graphics::GetAspectCorrectionMatrix(unsigned int layer) const
 	return mat4::Scaling(GetAspectRatio(layer) * GetInvViewAspectRatio(layer), 1.0f, 1.0f, 1.0f);
 }
 
-mat3 Graphics::GetWorldToPixelMapTransformMatrix(unsigned int layer) const
+Affine2D Graphics::GetWorldToPixelMapTransform(unsigned int layer) const
 {
 	return
-		mat3::Scaling(1.0f, -1.0f, 1.0f) *
-		mat3::Translation((float)Layers[layer].width / 2.0f, (float)Layers[layer].height / 2.0f);
+		Affine2D::Scaling(1.0f, -1.0f) *
+		Affine2D::Translation((float)Layers[layer].width / 2.0f, (float)Layers[layer].height / 2.0f);
 }
 
-mat3 Graphics::GetPixelMapToWorldTransformMatrix(unsigned int layer) const
+Affine2D Graphics::GetPixelMapToWorldTransform(unsigned int layer) const
 {
 	return
-		mat3::Translation(-(float)Layers[layer].width / 2.0f, -(float)Layers[layer].height / 2.0f) *
-		mat3::Scaling(1.0f, -1.0f, 1.0f);
+		Affine2D::Translation(-(float)Layers[layer].width / 2.0f, -(float)Layers[layer].height / 2.0f) *
+		Affine2D::Scaling(1.0f, -1.0f);
+}
+
+mat3 Graphics::GetWorldToPixelMapTransformMatrix(unsigned int layer) const
+{
+	return GetWorldToPixelMapTransform(layer).ToMat3();
+}
+
+mat3 Graphics::GetPixelMapToWorldTransformMatrix(unsigned int layer) const
+{
+	return GetPixelMapToWorldTransform(layer).ToMat3();
 }
 
 
@@ -5,6 +5,7 @@
 #include "BaseException.h"
 #include "Shaders.h"
 #include "Color.h"
+#include "Affine2D.h"
 #include <optional>
 #include <vector>
 #include <functional>
@@ -132,6 +133,7 @@ private:
 	mutable D3D11_MAPPED_SUBRESOURCE msr = {};
 	std::vector<Layer> Layers;
 	float4 fBackgroundColorRGBA = { 0.0f,0.0f,0.0f,1.0f };
+	UINT syncInterval = 1u;
 public:
 	Graphics() = delete;
 	Graphics(const Graphics& gfx) = delete;
@@ -139,6 +141,8 @@ public:
 	Graphics(HWND hWnd, unsigned int WindowWidth, unsigned int WindowHeight, std::vector<uint2> display_layer_dims);
 	void NewFrame();
 	void EndFrame() const;
+	void EnableVSync();
+	void DisableVSync();
 	const bool& isAutoManaged(unsigned int layer = 0u) const;
 	void AutoManage(unsigned int layer = 0u);
 	void ManuallyManage(unsigned int layer = 0u);
@@ -234,10 +238,13 @@ public:
 	void Scale(vec2 scalar, unsigned int layer = 0u);
 	void SetScale(vec2 scale, unsigned int layer = 0u);
 	const vec2& GetScale(unsigned int layer = 0u) const;
+	Affine2D GetTransform(unsigned int layer = 0u) const;
 	mat4 GetTransformationMatrix(unsigned int layer = 0u) const;
 	mat4 GetPreTransformMatrix(unsigned int layer = 0u) const;
 	mat4 GetPostTransformMatrix(unsigned int layer = 0u) const;
 	mat4 GetAspectCorrectionMatrix(unsigned int layer = 0u) const;
+	Affine2D GetWorldToPixelMapTransform(unsigned int layer = 0u) const;
+	Affine2D GetPixelMapToWorldTransform(unsigned int layer = 0u) const;
 	mat3 GetWorldToPixelMapTransformMatrix(unsigned int layer = 0u) const;
 	mat3 GetPixelMapToWorldTransformMatrix(unsigned int layer = 0u) const;
 };
@@ -126,6 +126,11 @@ unsigned int Image::GetHeight() const
 	return height;
 }
 
+Color* Image::GetPtrToImage()
+{
+	return pImage.get();
+}
+
 const Color* Image::GetPtrToImage() const
 {
 	return pImage.get();
@@ -607,7 +612,7 @@ void Image::Draw(Graphics& gfx, int X, int Y, std::function<Color(const Image&,
 		(-Y) * (Y < 0);
 	const unsigned int endX =
 		(xRes - X) * (width + X > xRes) +
-		(width) * (height + X <= xRes);
+		(width) * (width + X <= xRes);
 	const unsigned int endY =
 		(yRes - Y) * (height + Y > yRes) +
 		(height) * (height + Y <= yRes);
@@ -670,7 +675,7 @@ void Image::DrawWithTransparency(Graphics& gfx, int X, int Y, unsigned int layer
 		(-Y) * (Y < 0);
 	const unsigned int endX =
 		(xRes - X) * (width + X > xRes) +
-		(width) * (height + X <= xRes);
+		(width) * (width + X <= xRes);
 	const unsigned int endY =
 		(yRes - Y) * (height + Y > yRes) +
 		(height) * (height + Y <= yRes);
@@ -737,7 +742,7 @@ void Image::DrawWithTransparency(Graphics& gfx, int X, int Y, std::function<Colo
 		(-Y) * (Y < 0);
 	const unsigned int endX =
 		(xRes - X) * (width + X > xRes) +
-		(width) * (height + X <= xRes);
+		(width) * (width + X <= xRes);
 	const unsigned int endY =
 		(yRes - Y) * (height + Y > yRes) +
 		(height) * (height + Y <= yRes);
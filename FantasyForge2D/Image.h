@@ -19,6 +19,7 @@ public:
 	Image(const std::vector<Color>& image, unsigned int image_width);
 	unsigned int GetWidth() const;
 	unsigned int GetHeight() const;
+	Color* GetPtrToImage();
 	const Color* GetPtrToImage() const;
 	void SetPixel(unsigned int x, unsigned int y, const Color& color);
 	const Color& GetPixel(unsigned int x, unsigned int y) const;
@@ -0,0 +1,74 @@
+#include "InputRecorder.h"
+#include "BaseException.h"
+#include <assert.h>
+
+InputRecorder::InputRecorder(Keyboard& kbd, Mouse& mouse, const std::string& file_name)
+	:
+	kbd(kbd),
+	mouse(mouse),
+	fileName(file_name),
+	logOUT(file_name, std::ios::binary)
+{
+	assert(!kbd.pRecorder && !mouse.pRecorder);
+	if (!logOUT)
+	{
+		throw EXCPT_NOTE("Could not create input log!\n" + fileName);
+	}
+	const Header header = { LogID, Version };
+	logOUT.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	pending.reserve(ReservedRecords);
+	kbd.pRecorder = this;
+	mouse.pRecorder = this;
+}
+
+void InputRecorder::Capture(const Keyboard::Event& e)
+{
+	Record record = {};
+	record.source = Source::Keyboard;
+	record.type = (unsigned char)e.GetType();
+	record.keycode = e.GetKeycode();
+	pending.push_back(record);
+}
+
+void InputRecorder::Capture(const Mouse::Event& e)
+{
+	Record record = {};
+	record.source = Source::Mouse;
+	record.type = (unsigned char)e.GetType();
+	record.x = (short)e.GetMouseXAtEvent();
+	record.y = (short)e.GetMouseYAtEvent();
+	pending.push_back(record);
+}
+
+void InputRecorder::CaptureKeystateReset()
+{
+	Record record = {};
+	record.source = Source::KeystateReset;
+	pending.push_back(record);
+}
+
+void InputRecorder::CommitFrame(float dt)
+{
+	// input captured since the last commit is what the frame about to run will see
+	const Frame frame = { dt, (unsigned int)pending.size() };
+	logOUT.write(reinterpret_cast<const char*>(&frame), sizeof(Frame));
+	logOUT.write(reinterpret_cast<const char*>(pending.data()), std::streamsize(pending.size() * sizeof(Record)));
+	if (!logOUT)
+	{
+		throw EXCPT_NOTE("Could not write input log!\n" + fileName);
+	}
+	pending.clear();
+	++nFrames;
+}
+
+const unsigned int& InputRecorder::GetFrameCount() const
+{
+	return nFrames;
+}
+
+InputRecorder::~InputRecorder()
+{
+	kbd.pRecorder = nullptr;
+	mouse.pRecorder = nullptr;
+	logOUT.flush();
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "Keyboard.h"
+#include "Mouse.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+class InputRecorder
+{
+	friend class Keyboard;
+	friend class Mouse;
+public:
+	enum class Source : unsigned char
+	{
+		Keyboard,
+		Mouse,
+		KeystateReset
+	};
+	// the log is a header followed by one Frame per engine frame, each trailed by its nRecords input records
+	struct Header
+	{
+		unsigned int id;
+		unsigned int version;
+	};
+	struct Frame
+	{
+		float dt;
+		unsigned int nRecords;
+	};
+	struct Record
+	{
+		Source source;
+		unsigned char type;
+		unsigned char keycode;
+		unsigned char reserved;
+		short x;
+		short y;
+	};
+public:
+	static constexpr unsigned int LogID = 'IRFF';
+	static constexpr unsigned int Version = 1u;
+	static constexpr unsigned int ReservedRecords = 256u;
+private:
+	Keyboard& kbd;
+	Mouse& mouse;
+	std::string fileName;
+	std::ofstream logOUT;
+	std::vector<Record> pending;
+	unsigned int nFrames = 0u;
+private:
+	void Capture(const Keyboard::Event& e);
+	void Capture(const Mouse::Event& e);
+	void CaptureKeystateReset();
+public:
+	InputRecorder() = delete;
+	InputRecorder(Keyboard& kbd, Mouse& mouse, const std::string& file_name);
+	InputRecorder(const InputRecorder& recorder) = delete;
+	InputRecorder operator =(const InputRecorder& recorder) = delete;
+	void CommitFrame(float dt);
+	const unsigned int& GetFrameCount() const;
+	~InputRecorder();
+};
@@ -0,0 +1,157 @@
+#include "InputReplay.h"
+#include "BaseException.h"
+#include <assert.h>
+
+InputReplay::InputReplay(const std::string& file_name)
+	:
+	fileName(file_name)
+{
+	std::ifstream logIN(fileName, std::ios::binary | std::ios::ate);
+	if (!logIN)
+	{
+		throw EXCPT_NOTE("Could not open input log!\n" + fileName);
+	}
+	log.resize(size_t(logIN.tellg()));
+	logIN.seekg(0, std::ios::beg);
+	logIN.read(log.data(), std::streamsize(log.size()));
+	if (!logIN || log.size() < sizeof(InputRecorder::Header))
+	{
+		throw EXCPT_NOTE("Invalid input log!\n" + fileName);
+	}
+	InputRecorder::Header header;
+	memcpy(&header, log.data(), sizeof(InputRecorder::Header));
+	if (header.id != InputRecorder::LogID || header.version != InputRecorder::Version)
+	{
+		throw EXCPT_NOTE("Invalid input log!\n" + fileName);
+	}
+	// count whole frames up front; a log cut short by a crash simply ends at its last complete frame
+	size_t pos = sizeof(InputRecorder::Header);
+	while (log.size() - pos >= sizeof(InputRecorder::Frame))
+	{
+		InputRecorder::Frame frame;
+		memcpy(&frame, log.data() + pos, sizeof(InputRecorder::Frame));
+		const size_t frameSize = sizeof(InputRecorder::Frame) + size_t(frame.nRecords) * sizeof(InputRecorder::Record);
+		if (log.size() - pos < frameSize)
+		{
+			break;
+		}
+		pos += frameSize;
+		++nFrames;
+	}
+	Rewind();
+}
+
+void InputReplay::Dispatch(const InputRecorder::Record& record, Keyboard& kbd, Mouse& mouse)
+{
+	switch (record.source)
+	{
+		case InputRecorder::Source::Keyboard:
+		{
+			switch (Keyboard::Event::Type(record.type))
+			{
+				case Keyboard::Event::Type::KeyDown:
+					kbd.OnKeyDown(record.keycode);
+					break;
+				case Keyboard::Event::Type::KeyUp:
+					kbd.OnKeyUp(record.keycode);
+					break;
+				case Keyboard::Event::Type::Char:
+					kbd.OnChar(record.keycode);
+					break;
+			}
+			break;
+		}
+		case InputRecorder::Source::Mouse:
+		{
+			const int x = record.x;
+			const int y = record.y;
+			switch (Mouse::Event::Type(record.type))
+			{
+				case Mouse::Event::Type::MouseMove:
+					mouse.OnMouseSample(x, y, std::chrono::steady_clock::now());
+					mouse.OnMouseMove(x, y);
+					break;
+				case Mouse::Event::Type::LeftClick:
+					mouse.OnLeftClick(x, y);
+					break;
+				case Mouse::Event::Type::LeftDoubleClick:
+					mouse.OnLeftDoubleClick(x, y);
+					break;
+				case Mouse::Event::Type::RightClick:
+					mouse.OnRightClick(x, y);
+					break;
+				case Mouse::Event::Type::RightDoubleClick:
+					mouse.OnRightDoubleClick(x, y);
+					break;
+				case Mouse::Event::Type::MiddleClick:
+					mouse.OnMiddleClick(x, y);
+					break;
+				case Mouse::Event::Type::LeftRelease:
+					mouse.OnLeftRelease(x, y);
+					break;
+				case Mouse::Event::Type::RightRelease:
+					mouse.OnRightRelease(x, y);
+					break;
+				case Mouse::Event::Type::MiddleRelease:
+					mouse.OnMiddleRelease(x, y);
+					break;
+				case Mouse::Event::Type::ScrollUp:
+					mouse.OnScrollUp();
+					break;
+				case Mouse::Event::Type::ScrollDown:
+					mouse.OnScrollDown();
+					break;
+				case Mouse::Event::Type::EnterWindow:
+					mouse.OnMouseEnter();
+					break;
+				case Mouse::Event::Type::LeaveWindow:
+					mouse.OnMouseLeave();
+					break;
+			}
+			break;
+		}
+		case InputRecorder::Source::KeystateReset:
+		{
+			kbd.ClearKeystates();
+			break;
+		}
+	}
+}
+
+bool InputReplay::NextFrame(Keyboard& kbd, Mouse& mouse, float& dt)
+{
+	assert(!kbd.pRecorder && !mouse.pRecorder);
+	if (curFrame == nFrames)
+	{
+		return false;
+	}
+	InputRecorder::Frame frame;
+	memcpy(&frame, log.data() + readPos, sizeof(InputRecorder::Frame));
+	readPos += sizeof(InputRecorder::Frame);
+	for (unsigned int i = 0u; i < frame.nRecords; ++i)
+	{
+		InputRecorder::Record record;
+		memcpy(&record, log.data() + readPos, sizeof(InputRecorder::Record));
+		readPos += sizeof(InputRecorder::Record);
+		Dispatch(record, kbd, mouse);
+	}
+	dt = frame.dt;
+	++curFrame;
+	return true;
+}
+
+void InputReplay::Rewind()
+{
+	readPos = sizeof(InputRecorder::Header);
+	curFrame = 0u;
+}
+
+const unsigned int& InputReplay::GetFrameCount() const
+{
+	return nFrames;
+}
+
+const unsigned int& InputReplay::GetCurrentFrame() const
+{
+	return curFrame;
+}
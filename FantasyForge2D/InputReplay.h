@@ -0,0 +1,23 @@
+#pragma once
+#include "InputRecorder.h"
+
+class InputReplay
+{
+private:
+	std::string fileName;
+	std::vector<char> log;
+	size_t readPos = 0u;
+	unsigned int nFrames = 0u;
+	unsigned int curFrame = 0u;
+private:
+	static void Dispatch(const InputRecorder::Record& record, Keyboard& kbd, Mouse& mouse);
+public:
+	InputReplay() = delete;
+	InputReplay(const std::string& file_name);
+	InputReplay(const InputReplay& replay) = delete;
+	InputReplay operator =(const InputReplay& replay) = delete;
+	bool NextFrame(Keyboard& kbd, Mouse& mouse, float& dt);
+	void Rewind();
+	const unsigned int& GetFrameCount() const;
+	const unsigned int& GetCurrentFrame() const;
+};
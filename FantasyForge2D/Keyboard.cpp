@@ -1,25 +1,32 @@
 #include "Keyboard.h"
+#include "InputRecorder.h"
+
+void Keyboard::Emit(unsigned char keycode, Event::Type type)
+{
+	const Event e = Event(keycode, type);
+	eventQueue.Push(e);
+	if (pRecorder)
+	{
+		pRecorder->Capture(e);
+	}
+}
 
 void Keyboard::OnKeyDown(unsigned char keycode)
 {
 	keystates[keycode] = true;
-	eventQueue.push(Event(keycode, Event::Type::KeyDown));
-	TrimBuffer(eventQueue);
+	Emit(keycode, Event::Type::KeyDown);
 }
 
 void Keyboard::OnKeyUp(unsigned char keycode)
 {
 	keystates[keycode] = false;
-	eventQueue.push(Event(keycode, Event::Type::KeyUp));
-	TrimBuffer(eventQueue);
+	Emit(keycode, Event::Type::KeyUp);
 }
 
 void Keyboard::OnChar(unsigned char character)
 {
-	charBuffer.push(character);
-	eventQueue.push(Event(character, Event::Type::Char));
-	TrimBuffer(charBuffer);
-	TrimBuffer(eventQueue);
+	charBuffer.Push(character);
+	Emit(character, Event::Type::Char);
 }
 
 bool Keyboard::KeyIsPressed(unsigned char key) const
@@ -35,51 +42,54 @@ bool Keyboard::isInUse() const
 void Keyboard::ClearKeystates()
 {
 	keystates.reset();
+	if (pRecorder)
+	{
+		pRecorder->CaptureKeystateReset();
+	}
 }
 
 Keyboard::Event Keyboard::Read()
 {
-	if (!eventQueue.empty())
-	{
-		const auto e = eventQueue.front();
-		eventQueue.pop();
-		return e;
-	}
-	else
-	{
-		return Event();
-	}
+	Event e;
+	eventQueue.Pop(e);
+	return e;
+}
+
+unsigned int Keyboard::ReadEvents(Event* pEvents, unsigned int max_events)
+{
+	return eventQueue.Read(pEvents, max_events);
 }
 
 bool Keyboard::isActive() const
 {
-	return !eventQueue.empty();
+	return !eventQueue.IsEmpty();
 }
 
 void Keyboard::EmptyEventQueue()
 {
-	eventQueue = std::queue<Event>();
+	eventQueue.Clear();
 }
 
 unsigned char Keyboard::Get()
 {
-	if (!charBuffer.empty())
-	{
-		unsigned char character = charBuffer.front();
-		charBuffer.pop();
-		return character;
-	}
-	return 0u;
+	unsigned char character = 0u;
+	charBuffer.Pop(character);
+	return character;
+}
+
+unsigned int Keyboard::GetChars(unsigned char* pChars, unsigned int max_chars)
+{
+	return charBuffer.Read(pChars, max_chars);
 }
 
 bool Keyboard::isEmpty() const
 {
-	return charBuffer.empty();
+	return charBuffer.IsEmpty();
 }
 
 void Keyboard::EmptyCharacterBuffer()
 {
-	charBuffer = std::queue<unsigned char>();
+	charBuffer.Clear();
 }
 
 bool Keyboard::AutorepeatIsEnabled() const
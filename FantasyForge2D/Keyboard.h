@@ -1,11 +1,15 @@
 #pragma once
 #include <bitset>
-#include <queue>
 #include <optional>
+#include "SPSCQueue.h"
+
+class InputRecorder;
 
 class Keyboard
 {
 	friend class Window;
+	friend class InputRecorder;
+	friend class InputReplay;
 public:
 	static constexpr unsigned char nKeys = 255u;
 	static constexpr unsigned char BufferSize = 32u;
@@ -56,30 +60,28 @@ public:
 	};
 private:
 	std::bitset<nKeys> keystates = std::bitset<nKeys>();
-	std::queue<Event> eventQueue = std::queue<Event>();
-	std::queue<unsigned char> charBuffer = std::queue<unsigned char>();
+	// filled by the window procedure and drained by game code; a burst of input drops the oldest events but
+	// keeps typed text in order by refusing characters once the buffer is full
+	SPSCQueue<Event, BufferSize, QueueOverflow::OverwriteOldest> eventQueue;
+	SPSCQueue<unsigned char, BufferSize, QueueOverflow::Reject> charBuffer;
 	bool autorepeat = false;
+	InputRecorder* pRecorder = nullptr;
 private:
+	void Emit(unsigned char keycode, Event::Type type);
 	void OnKeyDown(unsigned char keycode);
 	void OnKeyUp(unsigned char keycode);
 	void OnChar(unsigned char character);
-	template <typename buffer>
-	void TrimBuffer(buffer& buf)
-	{
-		while (buf.size() >= BufferSize)
-		{
-			buf.pop();
-		}
-	}
 public:
 	Keyboard() = default;
 	bool KeyIsPressed(unsigned char key) const;
 	bool isInUse() const;
 	void ClearKeystates();
 	Event Read();
+	unsigned int ReadEvents(Event* pEvents, unsigned int max_events = BufferSize);
 	bool isActive() const;
 	void EmptyEventQueue();
 	unsigned char Get();
+	unsigned int GetChars(unsigned char* pChars, unsigned int max_chars = BufferSize);
 	bool isEmpty() const;
 	void EmptyCharacterBuffer();
 	bool AutorepeatIsEnabled() const;
@@ -1,12 +1,82 @@
 #include "Mouse.h"
+#include "InputRecorder.h"
 #include "Win32Includes.h"
 
+static constexpr unsigned long long PendingValid = 1ull << 63u;
+static constexpr unsigned int StampMask = (1u << 27u) - 1u;
+
+static unsigned long long PackMove(unsigned int stamp, int x, int y, bool l, bool r, bool m, bool w)
+{
+	return PendingValid |
+		(unsigned long long)w << 62u | (unsigned long long)m << 61u | (unsigned long long)r << 60u | (unsigned long long)l << 59u |
+		(unsigned long long)(stamp & StampMask) << 32u | (unsigned long long)(unsigned short)y << 16u | (unsigned short)x;
+}
+
+static Mouse::Event UnpackMove(unsigned long long pending)
+{
+	return Mouse::Event(Mouse::Event::Type::MouseMove, (short)pending, (short)(pending >> 16u),
+		(pending >> 59u & 1u) != 0u, (pending >> 60u & 1u) != 0u, (pending >> 61u & 1u) != 0u, (pending >> 62u & 1u) != 0u);
+}
+
+void Mouse::FlushPendingMove()
+{
+	const unsigned long long pending = pendingMove.exchange(0u, std::memory_order_acq_rel);
+	if (pending & PendingValid)
+	{
+		eventQueue.Push(UnpackMove(pending));
+	}
+}
+
+bool Mouse::TakePendingMove(Event& e)
+{
+	unsigned long long pending = pendingMove.load(std::memory_order_acquire);
+	if (!(pending & PendingValid) || ((pending >> 32u) & StampMask) != (eventQueue.GetHead() & StampMask))
+	{
+		return false;
+	}
+	if (!pendingMove.compare_exchange_strong(pending, 0u, std::memory_order_acq_rel))
+	{
+		return false;
+	}
+	e = UnpackMove(pending);
+	return true;
+}
+
+void Mouse::Emit(Event::Type type)
+{
+	FlushPendingMove();
+	const Event e = Event(type, x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow);
+	eventQueue.Push(e);
+	if (pRecorder)
+	{
+		pRecorder->Capture(e);
+	}
+}
+
 void Mouse::OnMouseMove(int _x, int _y)
 {
 	x = _x;
 	y = _y;
-	eventQueue.push(Event(Event::Type::MouseMove, x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow));
-	TrimEventQueue();
+	if (coalesceMoves)
+	{
+		pendingMove.store(PackMove(eventQueue.GetTail(), x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow), std::memory_order_release);
+		if (pRecorder)
+		{
+			pRecorder->Capture(Event(Event::Type::MouseMove, x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow));
+		}
+	}
+	else
+	{
+		Emit(Event::Type::MouseMove);
+	}
+}
+
+void Mouse::OnMouseSample(int _x, int _y, std::chrono::steady_clock::time_point time)
+{
+	if (pSamples)
+	{
+		pSamples->Push({ time, _x, _y });
+	}
 }
 
 void Mouse::OnLeftClick(int _x, int _y)
@@ -14,16 +84,14 @@ void Mouse::OnLeftClick(int _x, int _y)
 	x = _x;
 	y = _y;
 	leftIsClicked = true;
-	eventQueue.push(Event(Event::Type::LeftClick, x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow));
-	TrimEventQueue();
+	Emit(Event::Type::LeftClick);
 }
 
 void Mouse::OnLeftDoubleClick(int _x, int _y)
 {
 	x = _x;
 	y = _y;
-	eventQueue.push(Event(Event::Type::LeftDoubleClick, x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow));
-	TrimEventQueue();
+	Emit(Event::Type::LeftDoubleClick);
 }
 
 void Mouse::OnRightClick(int _x, int _y)
@@ -31,16 +99,14 @@ void Mouse::OnRightClick(int _x, int _y)
 	x = _x;
 	y = _y;
 	rightIsClicked = true;
-	eventQueue.push(Event(Event::Type::RightClick, x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow));
-	TrimEventQueue();
+	Emit(Event::Type::RightClick);
 }
 
 void Mouse::OnRightDoubleClick(int _x, int _y)
 {
 	x = _x;
 	y = _y;
-	eventQueue.push(Event(Event::Type::RightDoubleClick, x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow));
-	TrimEventQueue();
+	Emit(Event::Type::RightDoubleClick);
 }
 
 void Mouse::OnMiddleClick(int _x, int _y)
@@ -48,8 +114,7 @@ void Mouse::OnMiddleClick(int _x, int _y)
 	x = _x;
 	y = _y;
 	middleIsClicked = true;
-	eventQueue.push(Event(Event::Type::MiddleClick, x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow));
-	TrimEventQueue();
+	Emit(Event::Type::MiddleClick);
 }
 
 void Mouse::OnLeftRelease(int _x, int _y)
@@ -57,8 +122,7 @@ void Mouse::OnLeftRelease(int _x, int _y)
 	x = _x;
 	y = _y;
 	leftIsClicked = false;
-	eventQueue.push(Event(Event::Type::LeftRelease, x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow));
-	TrimEventQueue();
+	Emit(Event::Type::LeftRelease);
 }
 
 void Mouse::OnRightRelease(int _x, int _y)
@@ -66,8 +130,7 @@ void Mouse::OnRightRelease(int _x, int _y)
 	x = _x;
 	y = _y;
 	rightIsClicked = false;
-	eventQueue.push(Event(Event::Type::RightRelease, x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow));
-	TrimEventQueue();
+	Emit(Event::Type::RightRelease);
 }
 
 void Mouse::OnMiddleRelease(int _x, int _y)
@@ -75,8 +138,7 @@ void Mouse::OnMiddleRelease(int _x, int _y)
 	x = _x;
 	y = _y;
 	middleIsClicked = false;
-	eventQueue.push(Event(Event::Type::MiddleRelease, x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow));
-	TrimEventQueue();
+	Emit(Event::Type::MiddleRelease);
 }
 
 void Mouse::OnWheelScroll(int z)
@@ -102,36 +164,24 @@ void Mouse::OnWheelScroll(int z)
 
 void Mouse::OnScrollUp()
 {
-	eventQueue.push(Event(Event::Type::ScrollUp, x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow));
-	TrimEventQueue();
+	Emit(Event::Type::ScrollUp);
 }
 
 void Mouse::OnScrollDown()
 {
-	eventQueue.push(Event(Event::Type::ScrollDown, x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow));
-	TrimEventQueue();
+	Emit(Event::Type::ScrollDown);
 }
 
 void Mouse::OnMouseEnter()
 {
 	isInWindow = true;
-	eventQueue.push(Event(Event::Type::EnterWindow, x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow));
-	TrimEventQueue();
+	Emit(Event::Type::EnterWindow);
 }
 
 void Mouse::OnMouseLeave()
 {
 	isInWindow = false;
-	eventQueue.push(Event(Event::Type::LeaveWindow, x, y, leftIsClicked, rightIsClicked, middleIsClicked, isInWindow));
-	TrimEventQueue();
-}
-
-void Mouse::TrimEventQueue()
-{
-	while (eventQueue.size() >= BufferSize)
-	{
-		eventQueue.pop();
-	}
+	Emit(Event::Type::LeaveWindow);
 }
 
 int Mouse::GetX() const
@@ -179,26 +229,86 @@ void Mouse::ClearMouseStates()
 
 Mouse::Event Mouse::Read()
 {
-	if (!eventQueue.empty())
+	Event e;
+	if (!eventQueue.Pop(e))
+	{
+		TakePendingMove(e);
+	}
+	return e;
+}
+
+unsigned int Mouse::ReadEvents(Event* pEvents, unsigned int max_events)
+{
+	unsigned int nEvents = eventQueue.Read(pEvents, max_events);
+	if (nEvents < max_events && TakePendingMove(pEvents[nEvents]))
 	{
-		const auto e = eventQueue.front();
-		eventQueue.pop();
-		return e;
+		++nEvents;
 	}
-	return Event();
+	return nEvents;
 }
 
 bool Mouse::isActive() const
 {
-	return !eventQueue.empty();
+	return !eventQueue.IsEmpty() || (pendingMove.load(std::memory_order_acquire) & PendingValid);
 }
 
 void Mouse::EmptyEventQueue()
 {
-	eventQueue = std::queue<Event>();
+	eventQueue.Clear();
+	pendingMove.store(0u, std::memory_order_release);
+}
+
+bool Mouse::MovesAreCoalesced() const
+{
+	return coalesceMoves;
+}
+
+void Mouse::EnableMoveCoalescing()
+{
+	coalesceMoves = true;
+}
+
+void Mouse::DisableMoveCoalescing()
+{
+	coalesceMoves = false;
+}
+
+bool Mouse::isSampling() const
+{
+	return pSamples != nullptr;
+}
+
+void Mouse::EnableSampling()
+{
+	if (!pSamples)
+	{
+		pSamples = std::make_unique<SPSCQueue<Sample, SampleBufferSize, QueueOverflow::OverwriteOldest>>();
+		lastMovePoint.reset();
+	}
+}
+
+void Mouse::DisableSampling()
+{
+	pSamples.reset();
+	lastMovePoint.reset();
+}
+
+unsigned int Mouse::ReadSamples(Sample* pSampleBuffer, unsigned int max_samples)
+{
+	return pSamples ? pSamples->Read(pSampleBuffer, max_samples) : 0u;
 }
 
 void Mouse::Reset()
 {
-	*this = Mouse();
+	x = 0;
+	y = 0;
+	ClearMouseStates();
+	isInWindow = false;
+	scrollBuffer = 0;
+	EmptyEventQueue();
+	if (pSamples)
+	{
+		pSamples->Clear();
+	}
+	lastMovePoint.reset();
 }
@@ -1,13 +1,27 @@
 #pragma once
-#include <queue>
 #include <optional>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include "SPSCQueue.h"
+
+class InputRecorder;
 
 class Mouse
 {
 	friend class Window;
+	friend class InputRecorder;
+	friend class InputReplay;
 public:
 	static constexpr unsigned char BufferSize = 32u;
+	static constexpr unsigned int SampleBufferSize = 256u;
 public:
+	struct Sample
+	{
+		std::chrono::steady_clock::time_point time;
+		int x;
+		int y;
+	};
 	class Event
 	{
 	public:
@@ -140,9 +154,28 @@ private:
 	bool middleIsClicked = false;
 	bool isInWindow = false;
 	int scrollBuffer = 0;
-	std::queue<Event> eventQueue = std::queue<Event>();
+	SPSCQueue<Event, BufferSize, QueueOverflow::OverwriteOldest> eventQueue;
+	// with coalescing on, the latest move waits here instead of taking a queue slot; it is packed with the queue tail
+	// it followed so the reader only takes it after everything queued before it, and any other event flushes it first
+	bool coalesceMoves = true;
+	std::atomic<unsigned long long> pendingMove = 0u;
+	// samples come from the system's mouse move history (GetMouseMovePointsEx) rather than from WM_MOUSEMOVE, which Windows
+	// coalesces; lastMovePoint is the newest history entry already pushed, in screen coordinates and message time (ms)
+	struct MovePoint
+	{
+		unsigned long time;
+		int x;
+		int y;
+	};
+	std::unique_ptr<SPSCQueue<Sample, SampleBufferSize, QueueOverflow::OverwriteOldest>> pSamples = nullptr;
+	std::optional<MovePoint> lastMovePoint;
+	InputRecorder* pRecorder = nullptr;
 private:
+	void Emit(Event::Type type);
+	void FlushPendingMove();
+	bool TakePendingMove(Event& e);
 	void OnMouseMove(int _x, int _y);
+	void OnMouseSample(int _x, int _y, std::chrono::steady_clock::time_point time);
 	void OnLeftClick(int _x, int _y);
 	void OnLeftDoubleClick(int _x, int _y);
 	void OnRightClick(int _x, int _y);
@@ -156,7 +189,6 @@ private:
 	void OnScrollDown();
 	void OnMouseEnter();
 	void OnMouseLeave();
-	void TrimEventQueue();
 public:
 	Mouse() = default;
 	int GetX() const;
@@ -168,7 +200,15 @@ public:
 	bool isInUse() const;
 	void ClearMouseStates();
 	Event Read();
+	unsigned int ReadEvents(Event* pEvents, unsigned int max_events = BufferSize);
 	bool isActive() const;
 	void EmptyEventQueue();
+	bool MovesAreCoalesced() const;
+	void EnableMoveCoalescing();
+	void DisableMoveCoalescing();
+	bool isSampling() const;
+	void EnableSampling();
+	void DisableSampling();
+	unsigned int ReadSamples(Sample* pSampleBuffer, unsigned int max_samples = SampleBufferSize);
 	void Reset();
 };
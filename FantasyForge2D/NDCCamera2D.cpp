@@ -3,27 +3,29 @@
 NDCCamera2D::NDCCamera2D(vec2 gfx_dim)
 	:
 	Camera2D(),
-	halfGfxDim(gfx_dim / 2.0f)
+	toNDC(Affine2D::Scaling(2.0f / gfx_dim.x, 2.0f / gfx_dim.y)),
+	fromNDC(Affine2D::Scaling(gfx_dim.x / 2.0f, gfx_dim.y / 2.0f))
 {}
 
 NDCCamera2D::NDCCamera2D(vec2 gfx_dim, vec2 pos, float rot, float zoom)
 	:
 	Camera2D(pos, rot, zoom),
-	halfGfxDim(gfx_dim / 2.0f)
+	toNDC(Affine2D::Scaling(2.0f / gfx_dim.x, 2.0f / gfx_dim.y)),
+	fromNDC(Affine2D::Scaling(gfx_dim.x / 2.0f, gfx_dim.y / 2.0f))
 {}
 
 void NDCCamera2D::Move(vec2 delta)
 {
-	position += (delta / halfGfxDim).Rotated(rotation) * zoom;
+	position += (toNDC * Affine2D::Rotation(rotation) * Affine2D::Scaling(zoom, zoom)).TransformVector(delta);
 }
 
 void NDCCamera2D::SetPosition(vec2 pos)
 {
-	position = pos / halfGfxDim;
+	position = toNDC.TransformPoint(pos);
 }
 
 vec2 NDCCamera2D::GetPosition() const
 {
-	return position * halfGfxDim;
+	return fromNDC.TransformPoint(position);
 }
 
@@ -4,7 +4,8 @@
 class NDCCamera2D : public Camera2D
 {
 private:
-	const vec2 halfGfxDim;
+	const Affine2D toNDC;
+	const Affine2D fromNDC;
 public:
 	NDCCamera2D() = delete;
 	NDCCamera2D(vec2 gfx_dim);
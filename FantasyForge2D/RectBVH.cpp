@@ -0,0 +1,496 @@
+#include "RectBVH.h"
+#include "Clock.h"
+#include <algorithm>
+
+RectBVH::RectBVH(const std::vector<fRect>& rects, SplitMethod split_method)
+{
+	Rebuild(rects, split_method);
+}
+
+void RectBVH::Build(std::vector<BuildEntry>& entries, unsigned int first, unsigned int count, SplitMethod split_method)
+{
+	const unsigned int index = (unsigned int)nodes.size();
+	Node node = { FLT_MAX,FLT_MAX,-FLT_MAX,-FLT_MAX,0u,first,count };
+	for (unsigned int i = first; i < first + count; ++i)
+	{
+		node.minX = std::min(node.minX, entries[i].minX);
+		node.minY = std::min(node.minY, entries[i].minY);
+		node.maxX = std::max(node.maxX, entries[i].maxX);
+		node.maxY = std::max(node.maxY, entries[i].maxY);
+	}
+	nodes.push_back(node);
+	if (count <= MaxLeafSize)
+	{
+		nodes[index].skip = index + 1u;
+		return;
+	}
+	unsigned int nLeft = 0u;
+	if (split_method == SplitMethod::SAH)
+	{
+		nLeft = FindSAHSplit(entries, first, count);
+	}
+	if (nLeft == 0u || nLeft == count)
+	{
+		float minCX = FLT_MAX;
+		float minCY = FLT_MAX;
+		float maxCX = -FLT_MAX;
+		float maxCY = -FLT_MAX;
+		for (unsigned int i = first; i < first + count; ++i)
+		{
+			minCX = std::min(minCX, entries[i].centerX);
+			minCY = std::min(minCY, entries[i].centerY);
+			maxCX = std::max(maxCX, entries[i].centerX);
+			maxCY = std::max(maxCY, entries[i].centerY);
+		}
+		const bool isXAxis = maxCX - minCX >= maxCY - minCY;
+		nLeft = count / 2u;
+		std::nth_element(entries.begin() + first, entries.begin() + first + nLeft, entries.begin() + first + count,
+			[isXAxis](const BuildEntry& a, const BuildEntry& b)
+			{
+				return isXAxis ? a.centerX < b.centerX : a.centerY < b.centerY;
+			});
+	}
+	nodes[index].first = 0u;
+	nodes[index].count = 0u;
+	Build(entries, first, nLeft, split_method);
+	Build(entries, first + nLeft, count - nLeft, split_method);
+	nodes[index].skip = (unsigned int)nodes.size();
+}
+
+unsigned int RectBVH::FindSAHSplit(std::vector<BuildEntry>& entries, unsigned int first, unsigned int count) const
+{
+	float minCX = FLT_MAX;
+	float minCY = FLT_MAX;
+	float maxCX = -FLT_MAX;
+	float maxCY = -FLT_MAX;
+	for (unsigned int i = first; i < first + count; ++i)
+	{
+		minCX = std::min(minCX, entries[i].centerX);
+		minCY = std::min(minCY, entries[i].centerY);
+		maxCX = std::max(maxCX, entries[i].centerX);
+		maxCY = std::max(maxCY, entries[i].centerY);
+	}
+	const bool isXAxis = maxCX - minCX >= maxCY - minCY;
+	const float minC = isXAxis ? minCX : minCY;
+	const float extent = isXAxis ? maxCX - minCX : maxCY - minCY;
+	if (extent <= 0.0f)
+	{
+		return 0u;
+	}
+	const float binScale = (float)nBins / extent;
+	auto getBin = [=](const BuildEntry& e)
+	{
+		return std::min((unsigned int)(((isXAxis ? e.centerX : e.centerY) - minC) * binScale), nBins - 1u);
+	};
+	struct Bin
+	{
+		float minX = FLT_MAX;
+		float minY = FLT_MAX;
+		float maxX = -FLT_MAX;
+		float maxY = -FLT_MAX;
+		unsigned int count = 0u;
+	};
+	Bin bins[nBins];
+	for (unsigned int i = first; i < first + count; ++i)
+	{
+		Bin& bin = bins[getBin(entries[i])];
+		bin.minX = std::min(bin.minX, entries[i].minX);
+		bin.minY = std::min(bin.minY, entries[i].minY);
+		bin.maxX = std::max(bin.maxX, entries[i].maxX);
+		bin.maxY = std::max(bin.maxY, entries[i].maxY);
+		++bin.count;
+	}
+	float leftCost[nBins - 1u] = {};
+	Bin left;
+	for (unsigned int b = 0u; b < nBins - 1u; ++b)
+	{
+		left.minX = std::min(left.minX, bins[b].minX);
+		left.minY = std::min(left.minY, bins[b].minY);
+		left.maxX = std::max(left.maxX, bins[b].maxX);
+		left.maxY = std::max(left.maxY, bins[b].maxY);
+		left.count += bins[b].count;
+		leftCost[b] = left.count ? ((left.maxX - left.minX) + (left.maxY - left.minY)) * (float)left.count : 0.0f;
+	}
+	float bestCost = FLT_MAX;
+	unsigned int bestBin = 0u;
+	Bin right;
+	for (unsigned int b = nBins - 1u; b > 0u; --b)
+	{
+		right.minX = std::min(right.minX, bins[b].minX);
+		right.minY = std::min(right.minY, bins[b].minY);
+		right.maxX = std::max(right.maxX, bins[b].maxX);
+		right.maxY = std::max(right.maxY, bins[b].maxY);
+		right.count += bins[b].count;
+		const float rightCost = right.count ? ((right.maxX - right.minX) + (right.maxY - right.minY)) * (float)right.count : 0.0f;
+		const float cost = leftCost[b - 1u] + rightCost;
+		if (right.count < count && right.count > 0u && cost < bestCost)
+		{
+			bestCost = cost;
+			bestBin = b;
+		}
+	}
+	if (bestBin == 0u)
+	{
+		return 0u;
+	}
+	const auto mid = std::partition(entries.begin() + first, entries.begin() + first + count,
+		[&](const BuildEntry& e)
+		{
+			return getBin(e) < bestBin;
+		});
+	return (unsigned int)(mid - (entries.begin() + first));
+}
+
+float RectBVH::DistanceSq(const Node& node, vec2 point)
+{
+	const float dx = std::max(std::max(node.minX - point.x, point.x - node.maxX), 0.0f);
+	const float dy = std::max(std::max(node.minY - point.y, point.y - node.maxY), 0.0f);
+	return dx * dx + dy * dy;
+}
+
+float RectBVH::DistanceSq(const fRect& rect, vec2 point)
+{
+	const float dx = std::max(std::max(rect.pos.x - point.x, point.x - (rect.pos.x + rect.width)), 0.0f);
+	const float dy = std::max(std::max(rect.pos.y - point.y, point.y - (rect.pos.y + rect.height)), 0.0f);
+	return dx * dx + dy * dy;
+}
+
+bool RectBVH::IntersectSegment(float minX, float minY, float maxX, float maxY, vec2 origin, vec2 dir, vec2 inv_dir, float t_max, float& t_entry)
+{
+	float tEnter = 0.0f;
+	float tExit = t_max;
+	if (dir.x != 0.0f)
+	{
+		const float tx0 = (minX - origin.x) * inv_dir.x;
+		const float tx1 = (maxX - origin.x) * inv_dir.x;
+		tEnter = std::max(tEnter, std::min(tx0, tx1));
+		tExit = std::min(tExit, std::max(tx0, tx1));
+	}
+	else if (origin.x < minX || origin.x > maxX)
+	{
+		return false;
+	}
+	if (dir.y != 0.0f)
+	{
+		const float ty0 = (minY - origin.y) * inv_dir.y;
+		const float ty1 = (maxY - origin.y) * inv_dir.y;
+		tEnter = std::max(tEnter, std::min(ty0, ty1));
+		tExit = std::min(tExit, std::max(ty0, ty1));
+	}
+	else if (origin.y < minY || origin.y > maxY)
+	{
+		return false;
+	}
+	t_entry = tEnter;
+	return tEnter <= tExit;
+}
+
+void RectBVH::Rebuild(const std::vector<fRect>& rects, SplitMethod split_method)
+{
+	Clear();
+	if (rects.empty())
+	{
+		return;
+	}
+	const unsigned int count = (unsigned int)rects.size();
+	std::vector<BuildEntry> entries;
+	entries.reserve(count);
+	for (unsigned int i = 0u; i < count; ++i)
+	{
+		const fRect& r = rects[i];
+		entries.push_back({ r.pos.x,r.pos.y,r.pos.x + r.width,r.pos.y + r.height,r.pos.x + r.width / 2.0f,r.pos.y + r.height / 2.0f,i });
+	}
+	nodes.reserve(2u * count / MaxLeafSize + 1u);
+	Build(entries, 0u, count, split_method);
+	this->rects.reserve(count);
+	indices.reserve(count);
+	for (const BuildEntry& e : entries)
+	{
+		this->rects.push_back(rects[e.index]);
+		indices.push_back(e.index);
+	}
+}
+
+void RectBVH::Clear()
+{
+	nodes.clear();
+	rects.clear();
+	indices.clear();
+}
+
+bool RectBVH::IsEmpty() const
+{
+	return nodes.empty();
+}
+
+unsigned int RectBVH::GetCount() const
+{
+	return (unsigned int)rects.size();
+}
+
+unsigned int RectBVH::GetNodeCount() const
+{
+	return (unsigned int)nodes.size();
+}
+
+fRect RectBVH::GetBounds() const
+{
+	assert(!IsEmpty());
+	const Node& root = nodes.front();
+	return fRect({ root.minX,root.minY }, root.maxX - root.minX, root.maxY - root.minY);
+}
+
+unsigned int RectBVH::QueryRect(const fRect& rect, std::vector<unsigned int>& results) const
+{
+	const unsigned int nStart = (unsigned int)results.size();
+	const float minX = rect.pos.x;
+	const float minY = rect.pos.y;
+	const float maxX = rect.pos.x + rect.width;
+	const float maxY = rect.pos.y + rect.height;
+	const unsigned int nNodes = (unsigned int)nodes.size();
+	unsigned int i = 0u;
+	while (i < nNodes)
+	{
+		const Node& node = nodes[i];
+		if (node.maxX >= minX && node.minX <= maxX && node.maxY >= minY && node.minY <= maxY)
+		{
+			for (unsigned int j = node.first; j < node.first + node.count; ++j)
+			{
+				if (rect.IsTouching(rects[j]))
+				{
+					results.push_back(indices[j]);
+				}
+			}
+			++i;
+		}
+		else
+		{
+			i = node.skip;
+		}
+	}
+	return (unsigned int)results.size() - nStart;
+}
+
+bool RectBVH::Overlaps(const fRect& rect) const
+{
+	const float minX = rect.pos.x;
+	const float minY = rect.pos.y;
+	const float maxX = rect.pos.x + rect.width;
+	const float maxY = rect.pos.y + rect.height;
+	const unsigned int nNodes = (unsigned int)nodes.size();
+	unsigned int i = 0u;
+	while (i < nNodes)
+	{
+		const Node& node = nodes[i];
+		if (node.maxX >= minX && node.minX <= maxX && node.maxY >= minY && node.minY <= maxY)
+		{
+			for (unsigned int j = node.first; j < node.first + node.count; ++j)
+			{
+				if (rect.IsTouching(rects[j]))
+				{
+					return true;
+				}
+			}
+			++i;
+		}
+		else
+		{
+			i = node.skip;
+		}
+	}
+	return false;
+}
+
+unsigned int RectBVH::QueryPoint(vec2 point, std::vector<unsigned int>& results) const
+{
+	const unsigned int nStart = (unsigned int)results.size();
+	const unsigned int nNodes = (unsigned int)nodes.size();
+	unsigned int i = 0u;
+	while (i < nNodes)
+	{
+		const Node& node = nodes[i];
+		if (point.x >= node.minX && point.x <= node.maxX && point.y >= node.minY && point.y <= node.maxY)
+		{
+			for (unsigned int j = node.first; j < node.first + node.count; ++j)
+			{
+				if (rects[j].ContainsPoint(point))
+				{
+					results.push_back(indices[j]);
+				}
+			}
+			++i;
+		}
+		else
+		{
+			i = node.skip;
+		}
+	}
+	return (unsigned int)results.size() - nStart;
+}
+
+bool RectBVH::ContainsPoint(vec2 point) const
+{
+	const unsigned int nNodes = (unsigned int)nodes.size();
+	unsigned int i = 0u;
+	while (i < nNodes)
+	{
+		const Node& node = nodes[i];
+		if (point.x >= node.minX && point.x <= node.maxX && point.y >= node.minY && point.y <= node.maxY)
+		{
+			for (unsigned int j = node.first; j < node.first + node.count; ++j)
+			{
+				if (rects[j].ContainsPoint(point))
+				{
+					return true;
+				}
+			}
+			++i;
+		}
+		else
+		{
+			i = node.skip;
+		}
+	}
+	return false;
+}
+
+std::optional<unsigned int> RectBVH::QueryNearest(vec2 point, float max_distance) const
+{
+	std::optional<unsigned int> nearest;
+	float bestDistSq = max_distance * max_distance;
+	const unsigned int nNodes = (unsigned int)nodes.size();
+	unsigned int i = 0u;
+	while (i < nNodes)
+	{
+		const Node& node = nodes[i];
+		if (DistanceSq(node, point) <= bestDistSq)
+		{
+			for (unsigned int j = node.first; j < node.first + node.count; ++j)
+			{
+				const float distSq = DistanceSq(rects[j], point);
+				if (distSq <= bestDistSq)
+				{
+					bestDistSq = distSq;
+					nearest = indices[j];
+				}
+			}
+			++i;
+		}
+		else
+		{
+			i = node.skip;
+		}
+	}
+	return nearest;
+}
+
+std::optional<RectBVH::RayHit> RectBVH::Raycast(vec2 p0, vec2 p1) const
+{
+	const vec2 dir = p1 - p0;
+	if (dir.x == 0.0f && dir.y == 0.0f)
+	{
+		return std::optional<RayHit>();
+	}
+	const vec2 invDir = { dir.x != 0.0f ? 1.0f / dir.x : 0.0f,dir.y != 0.0f ? 1.0f / dir.y : 0.0f };
+	std::optional<RayHit> hit;
+	float bestT = 1.0f;
+	float t = 0.0f;
+	const unsigned int nNodes = (unsigned int)nodes.size();
+	unsigned int i = 0u;
+	while (i < nNodes)
+	{
+		const Node& node = nodes[i];
+		if (IntersectSegment(node.minX, node.minY, node.maxX, node.maxY, p0, dir, invDir, bestT, t))
+		{
+			for (unsigned int j = node.first; j < node.first + node.count; ++j)
+			{
+				const fRect& r = rects[j];
+				if (IntersectSegment(r.pos.x, r.pos.y, r.pos.x + r.width, r.pos.y + r.height, p0, dir, invDir, bestT, t) && (!hit || t < bestT))
+				{
+					bestT = t;
+					hit = RayHit{ indices[j],t,p0 + dir * t };
+				}
+			}
+			++i;
+		}
+		else
+		{
+			i = node.skip;
+		}
+	}
+	return hit;
+}
+
+RectBVH::BenchmarkResult RectBVH::Benchmark(const std::vector<fRect>& rects, const std::vector<fRect>& queries, SplitMethod split_method)
+{
+	BenchmarkResult result = {};
+	Clock timer;
+	const RectBVH bvh(rects, split_method);
+	result.buildTime = timer.Mark();
+	std::vector<unsigned int> hits;
+	unsigned int nBVHHits = 0u;
+	for (const fRect& q : queries)
+	{
+		hits.clear();
+		nBVHHits += bvh.QueryRect(q, hits);
+	}
+	result.bvhTime = timer.Mark();
+	unsigned int nBruteForceHits = 0u;
+	for (const fRect& q : queries)
+	{
+		for (const fRect& r : rects)
+		{
+			nBruteForceHits += q.IsTouching(r);
+		}
+	}
+	result.bruteForceTime = timer.Mark();
+	result.nHits = nBVHHits;
+	result.isRectMatching = nBVHHits == nBruteForceHits;
+	result.isPointMatching = true;
+	result.isNearestMatching = true;
+	result.isRaycastMatching = true;
+	for (const fRect& q : queries)
+	{
+		const vec2 center = q.pos + vec2(q.width, q.height) / 2.0f;
+		for (const vec2& point : { q.pos,center })
+		{
+			hits.clear();
+			const unsigned int nPointHits = bvh.QueryPoint(point, hits);
+			unsigned int nBruteForcePointHits = 0u;
+			for (const fRect& r : rects)
+			{
+				nBruteForcePointHits += r.ContainsPoint(point);
+			}
+			result.isPointMatching &= nPointHits == nBruteForcePointHits && bvh.ContainsPoint(point) == (nBruteForcePointHits > 0u);
+		}
+		float bruteForceDistSq = FLT_MAX;
+		for (const fRect& r : rects)
+		{
+			bruteForceDistSq = std::min(bruteForceDistSq, DistanceSq(r, center));
+		}
+		const std::optional<unsigned int> nearest = bvh.QueryNearest(center);
+		result.isNearestMatching &= rects.empty() ? !nearest : nearest && DistanceSq(rects[*nearest], center) == bruteForceDistSq;
+		const vec2 ends[] = { q.pos + vec2(q.width, q.height),q.pos + vec2(q.width, 0.0f),q.pos + vec2(0.0f, q.height),q.pos };
+		for (const vec2& p1 : ends)
+		{
+			const vec2 dir = p1 - q.pos;
+			const vec2 invDir = { dir.x != 0.0f ? 1.0f / dir.x : 0.0f,dir.y != 0.0f ? 1.0f / dir.y : 0.0f };
+			std::optional<float> bruteForceT;
+			if (dir.x != 0.0f || dir.y != 0.0f)
+			{
+				for (const fRect& r : rects)
+				{
+					float t = 0.0f;
+					if (IntersectSegment(r.pos.x, r.pos.y, r.pos.x + r.width, r.pos.y + r.height, q.pos, dir, invDir, 1.0f, t) && (!bruteForceT || t < *bruteForceT))
+					{
+						bruteForceT = t;
+					}
+				}
+			}
+			const std::optional<RayHit> hit = bvh.Raycast(q.pos, p1);
+			result.isRaycastMatching &= bool(hit) == bool(bruteForceT) && (!hit || hit->t == *bruteForceT);
+		}
+	}
+	result.isMatching = result.isRectMatching && result.isPointMatching && result.isNearestMatching && result.isRaycastMatching;
+	return result;
+}
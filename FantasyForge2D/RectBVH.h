@@ -0,0 +1,83 @@
+#pragma once
+#include "Rect.h"
+#include <vector>
+#include <optional>
+#include <cfloat>
+
+class RectBVH
+{
+public:
+	enum class SplitMethod
+	{
+		SAH,
+		Median
+	};
+	struct RayHit
+	{
+		unsigned int index;
+		float t;
+		vec2 point;
+	};
+	struct BenchmarkResult
+	{
+		float buildTime;
+		float bvhTime;
+		float bruteForceTime;
+		unsigned int nHits;
+		bool isRectMatching;
+		bool isPointMatching;
+		bool isNearestMatching;
+		bool isRaycastMatching;
+		bool isMatching;
+	};
+private:
+	struct Node
+	{
+		float minX;
+		float minY;
+		float maxX;
+		float maxY;
+		unsigned int skip;
+		unsigned int first;
+		unsigned int count;
+	};
+	struct BuildEntry
+	{
+		float minX;
+		float minY;
+		float maxX;
+		float maxY;
+		float centerX;
+		float centerY;
+		unsigned int index;
+	};
+private:
+	static constexpr unsigned int MaxLeafSize = 4u;
+	static constexpr unsigned int nBins = 16u;
+	std::vector<Node> nodes;
+	std::vector<fRect> rects;
+	std::vector<unsigned int> indices;
+private:
+	void Build(std::vector<BuildEntry>& entries, unsigned int first, unsigned int count, SplitMethod split_method);
+	unsigned int FindSAHSplit(std::vector<BuildEntry>& entries, unsigned int first, unsigned int count) const;
+	static float DistanceSq(const Node& node, vec2 point);
+	static float DistanceSq(const fRect& rect, vec2 point);
+	static bool IntersectSegment(float minX, float minY, float maxX, float maxY, vec2 origin, vec2 dir, vec2 inv_dir, float t_max, float& t_entry);
+public:
+	RectBVH() = default;
+	RectBVH(const std::vector<fRect>& rects, SplitMethod split_method = SplitMethod::SAH);
+	void Rebuild(const std::vector<fRect>& rects, SplitMethod split_method = SplitMethod::SAH);
+	void Clear();
+	bool IsEmpty() const;
+	unsigned int GetCount() const;
+	unsigned int GetNodeCount() const;
+	fRect GetBounds() const;
+	unsigned int QueryRect(const fRect& rect, std::vector<unsigned int>& results) const;
+	bool Overlaps(const fRect& rect) const;
+	unsigned int QueryPoint(vec2 point, std::vector<unsigned int>& results) const;
+	bool ContainsPoint(vec2 point) const;
+	std::optional<unsigned int> QueryNearest(vec2 point, float max_distance = FLT_MAX) const;
+	std::optional<RayHit> Raycast(vec2 p0, vec2 p1) const;
+public:
+	static BenchmarkResult Benchmark(const std::vector<fRect>& rects, const std::vector<fRect>& queries, SplitMethod split_method = SplitMethod::SAH);
+};
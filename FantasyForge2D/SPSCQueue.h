@@ -0,0 +1,137 @@
+#pragma once
+#include <atomic>
+
+enum class QueueOverflow
+{
+	Reject,
+	OverwriteOldest
+};
+
+template <typename T, unsigned int capacity, QueueOverflow overflow = QueueOverflow::Reject>
+class SPSCQueue
+{
+	static_assert(capacity > 0u && (capacity & (capacity - 1u)) == 0u, "SPSCQueue capacity must be a power of two");
+private:
+	static constexpr unsigned int Mask = capacity - 1u;
+	static constexpr bool Overwrite = overflow == QueueOverflow::OverwriteOldest;
+	// head is only written by the consumer and tail only by the producer; keep them on separate cache lines
+	// when overwriting, the producer also advances head on a full queue, so the consumer claims items with a CAS
+	// and throws away anything it copied from a slot that was reused underneath it
+	alignas(64) std::atomic<unsigned int> head = 0u;
+	alignas(64) std::atomic<unsigned int> tail = 0u;
+	alignas(64) T items[capacity];
+public:
+	SPSCQueue() = default;
+	SPSCQueue(const SPSCQueue& queue) = delete;
+	SPSCQueue operator =(const SPSCQueue& queue) = delete;
+	bool Push(const T& item)
+	{
+		const unsigned int curTail = tail.load(std::memory_order_relaxed);
+		unsigned int curHead = head.load(std::memory_order_acquire);
+		if (curTail - curHead == capacity)
+		{
+			if constexpr (!Overwrite)
+			{
+				return false;
+			}
+			else
+			{
+				// a failed exchange means the consumer freed the slot first
+				head.compare_exchange_strong(curHead, curHead + 1u, std::memory_order_acq_rel);
+			}
+		}
+		items[curTail & Mask] = item;
+		tail.store(curTail + 1u, std::memory_order_release);
+		return true;
+	}
+	bool Pop(T& item)
+	{
+		unsigned int curHead = head.load(Overwrite ? std::memory_order_acquire : std::memory_order_relaxed);
+		while (true)
+		{
+			if (curHead == tail.load(std::memory_order_acquire))
+			{
+				return false;
+			}
+			if constexpr (!Overwrite)
+			{
+				item = items[curHead & Mask];
+				head.store(curHead + 1u, std::memory_order_release);
+				return true;
+			}
+			else
+			{
+				const T copy = items[curHead & Mask];
+				if (head.compare_exchange_weak(curHead, curHead + 1u, std::memory_order_acq_rel))
+				{
+					item = copy;
+					return true;
+				}
+			}
+		}
+	}
+	// copies up to max_items in queue order and releases them with a single head update
+	unsigned int Read(T* pItems, unsigned int max_items)
+	{
+		unsigned int curHead = head.load(Overwrite ? std::memory_order_acquire : std::memory_order_relaxed);
+		while (true)
+		{
+			const unsigned int available = tail.load(std::memory_order_acquire) - curHead;
+			const unsigned int n = available < max_items ? available : max_items;
+			for (unsigned int i = 0u; i < n; ++i)
+			{
+				pItems[i] = items[(curHead + i) & Mask];
+			}
+			if constexpr (!Overwrite)
+			{
+				head.store(curHead + n, std::memory_order_release);
+				return n;
+			}
+			else if (n == 0u || head.compare_exchange_weak(curHead, curHead + n, std::memory_order_acq_rel))
+			{
+				return n;
+			}
+		}
+	}
+	template <typename F>
+	unsigned int Drain(F&& consume)
+	{
+		static_assert(!Overwrite, "Drain hands out items in place; use Read on an overwriting queue");
+		const unsigned int curHead = head.load(std::memory_order_relaxed);
+		const unsigned int curTail = tail.load(std::memory_order_acquire);
+		for (unsigned int i = curHead; i != curTail; ++i)
+		{
+			consume(items[i & Mask]);
+		}
+		head.store(curTail, std::memory_order_release);
+		return curTail - curHead;
+	}
+	void Clear()
+	{
+		unsigned int curHead = head.load(std::memory_order_acquire);
+		while (!head.compare_exchange_weak(curHead, tail.load(std::memory_order_acquire), std::memory_order_acq_rel));
+	}
+	// running positions; a tail recorded by the producer equals the head once everything pushed before it was consumed
+	unsigned int GetHead() const
+	{
+		return head.load(std::memory_order_acquire);
+	}
+	unsigned int GetTail() const
+	{
+		return tail.load(std::memory_order_acquire);
+	}
+	unsigned int GetSize() const
+	{
+		const unsigned int curHead = head.load(std::memory_order_acquire);
+		const unsigned int size = tail.load(std::memory_order_acquire) - curHead;
+		return size < capacity ? size : capacity;
+	}
+	bool IsEmpty() const
+	{
+		return GetSize() == 0u;
+	}
+	static constexpr unsigned int GetCapacity()
+	{
+		return capacity;
+	}
+};
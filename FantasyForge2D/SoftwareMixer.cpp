@@ -0,0 +1,591 @@
+#include "SoftwareMixer.h"
+#include "WaveFile.h"
+#include "Clock.h"
+#include <emmintrin.h>
+
+static constexpr unsigned long long FracMask = 0xFFFFFFFFull;
+static constexpr float FracScale = 1.0f / 4294967296.0f;
+
+static float SampleToFloat(short sample)
+{
+	return float(sample) * (1.0f / 32768.0f);
+}
+
+static float SampleToFloat(float sample)
+{
+	return sample;
+}
+
+static __m128 Load4(const short* pSamples)
+{
+	const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSamples));
+	const __m128i widened = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+	return _mm_mul_ps(_mm_cvtepi32_ps(widened), _mm_set1_ps(1.0f / 32768.0f));
+}
+
+static __m128 Load4(const float* pSamples)
+{
+	return _mm_loadu_ps(pSamples);
+}
+
+template <typename T, unsigned int n_channels>
+static void Convolve(const T* pWindow, const float* pCoefs, float* pOut)
+{
+	// the window holds nTaps frames, so a stereo window spans four vectors of interleaved LRLR pairs
+	__m128 acc = _mm_mul_ps(Load4(pWindow), _mm_load_ps(pCoefs));
+	acc = _mm_add_ps(acc, _mm_mul_ps(Load4(pWindow + 4), _mm_load_ps(pCoefs + 4)));
+	if constexpr (n_channels == 2u)
+	{
+		acc = _mm_add_ps(acc, _mm_mul_ps(Load4(pWindow + 8), _mm_load_ps(pCoefs + 8)));
+		acc = _mm_add_ps(acc, _mm_mul_ps(Load4(pWindow + 12), _mm_load_ps(pCoefs + 12)));
+		acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+		_mm_storel_pi(reinterpret_cast<__m64*>(pOut), acc);
+	}
+	else
+	{
+		acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+		acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(1, 1, 1, 1)));
+		pOut[0] = _mm_cvtss_f32(acc);
+		pOut[1] = pOut[0];
+	}
+}
+
+void SoftwareMixer::UpdateStep(Voice& voice) const
+{
+	const double ratio = double(voice.freqMod) * double(voice.sampleRate) / double(sampleRate);
+	voice.step = (unsigned long long)(ratio * 4294967296.0);
+}
+
+bool SoftwareMixer::RenderVoice(Voice& voice, float* pOut)
+{
+	if (voice.pEntry)
+	{
+		return RenderCompressed(voice, pOut);
+	}
+	const bool isShort = voice.type == SampleType::Int16;
+	const bool isStereo = voice.nChannels == 2u;
+	if (interpolation == Interpolation::Linear)
+	{
+		if (isShort)
+		{
+			return isStereo ?
+				RenderVoice<short, 2u, Interpolation::Linear>(voice, static_cast<const short*>(voice.pSamples), pOut, blockFrames) :
+				RenderVoice<short, 1u, Interpolation::Linear>(voice, static_cast<const short*>(voice.pSamples), pOut, blockFrames);
+		}
+		return isStereo ?
+			RenderVoice<float, 2u, Interpolation::Linear>(voice, static_cast<const float*>(voice.pSamples), pOut, blockFrames) :
+			RenderVoice<float, 1u, Interpolation::Linear>(voice, static_cast<const float*>(voice.pSamples), pOut, blockFrames);
+	}
+	if (isShort)
+	{
+		return isStereo ?
+			RenderVoice<short, 2u, Interpolation::Polyphase>(voice, static_cast<const short*>(voice.pSamples), pOut, blockFrames) :
+			RenderVoice<short, 1u, Interpolation::Polyphase>(voice, static_cast<const short*>(voice.pSamples), pOut, blockFrames);
+	}
+	return isStereo ?
+		RenderVoice<float, 2u, Interpolation::Polyphase>(voice, static_cast<const float*>(voice.pSamples), pOut, blockFrames) :
+		RenderVoice<float, 1u, Interpolation::Polyphase>(voice, static_cast<const float*>(voice.pSamples), pOut, blockFrames);
+}
+
+template <typename T, unsigned int n_channels, SoftwareMixer::Interpolation interp>
+bool SoftwareMixer::RenderVoice(Voice& voice, const T* pSamples, float* pOut, unsigned int n_frames) const
+{
+	const unsigned long long end = (unsigned long long)voice.nFrames << 32;
+	for (unsigned int f = 0u; f < n_frames; ++f)
+	{
+		if (voice.position >= end)
+		{
+			if (!voice.isLooping)
+			{
+				std::fill(pOut + f * nOutputChannels, pOut + n_frames * nOutputChannels, 0.0f);
+				voice.isActive = false;
+				return false;
+			}
+			voice.position %= end;
+		}
+		const unsigned int index = (unsigned int)(voice.position >> 32);
+		float* pFrame = pOut + f * nOutputChannels;
+		if constexpr (interp == Interpolation::Linear)
+		{
+			const float t = float(voice.position & FracMask) * FracScale;
+			const unsigned int next = index + 1u < voice.nFrames ? index + 1u : (voice.isLooping ? 0u : index);
+			const float l0 = SampleToFloat(pSamples[index * n_channels]);
+			const float l1 = SampleToFloat(pSamples[next * n_channels]);
+			pFrame[0] = l0 + (l1 - l0) * t;
+			if constexpr (n_channels == 2u)
+			{
+				const float r0 = SampleToFloat(pSamples[index * n_channels + 1u]);
+				const float r1 = SampleToFloat(pSamples[next * n_channels + 1u]);
+				pFrame[1] = r0 + (r1 - r0) * t;
+			}
+			else
+			{
+				pFrame[1] = pFrame[0];
+			}
+		}
+		else
+		{
+			const unsigned int phase = (unsigned int)(((voice.position & FracMask) * nPhases) >> 32);
+			FilterFrame<T, n_channels>(voice, pSamples, index, phase, pFrame);
+		}
+		voice.position += voice.step;
+	}
+	return true;
+}
+
+template <typename T, unsigned int n_channels>
+void SoftwareMixer::FilterFrame(const Voice& voice, const T* pSamples, unsigned int index, unsigned int phase, float* pOut)
+{
+	const FilterBank& bank = GetFilterBank();
+	const float* pCoefs = n_channels == 2u ? bank.stereo[phase] : bank.mono[phase];
+	constexpr unsigned int nBefore = nTaps / 2u - 1u;
+	constexpr unsigned int nAfter = nTaps / 2u;
+	if (index >= nBefore && index + nAfter < voice.nFrames)
+	{
+		Convolve<T, n_channels>(pSamples + (index - nBefore) * n_channels, pCoefs, pOut);
+		return;
+	}
+	// near the edges the taps are gathered one by one, wrapping for loops and padding with silence otherwise
+	alignas(16) float window[nTaps * n_channels];
+	for (unsigned int j = 0u; j < nTaps; ++j)
+	{
+		long long source = (long long)index - (long long)nBefore + (long long)j;
+		bool isInside = source >= 0 && source < (long long)voice.nFrames;
+		if (!isInside && voice.isLooping)
+		{
+			source = ((source % voice.nFrames) + voice.nFrames) % voice.nFrames;
+			isInside = true;
+		}
+		for (unsigned int c = 0u; c < n_channels; ++c)
+		{
+			window[j * n_channels + c] = isInside ? SampleToFloat(pSamples[source * n_channels + c]) : 0.0f;
+		}
+	}
+	Convolve<float, n_channels>(window, pCoefs, pOut);
+}
+
+bool SoftwareMixer::RenderCompressed(Voice& voice, float* pOut)
+{
+	// each run decodes just the frames it reads plus the filter margins, so the PCM paths always see an interior window
+	constexpr unsigned int nBefore = nTaps / 2u - 1u;
+	DecodeCache& cache = decodeCaches[&voice - voices.data()];
+	const unsigned long long end = (unsigned long long)voice.nFrames << 32;
+	unsigned int nRendered = 0u;
+	while (nRendered < blockFrames)
+	{
+		if (voice.position >= end)
+		{
+			if (!voice.isLooping)
+			{
+				std::fill(pOut + nRendered * nOutputChannels, pOut + blockFrames * nOutputChannels, 0.0f);
+				voice.isActive = false;
+				return false;
+			}
+			voice.position %= end;
+		}
+		// a run stops at the end of the sound so that looping restarts with a fresh window
+		const unsigned long long nUntilEnd = voice.step > 0u ? (end - voice.position + voice.step - 1u) / voice.step : blockFrames;
+		const unsigned int nFrames = (unsigned int)std::min<unsigned long long>(blockFrames - nRendered, nUntilEnd);
+		const unsigned int first = (unsigned int)(voice.position >> 32);
+		const unsigned int last = (unsigned int)((voice.position + voice.step * (nFrames - 1u)) >> 32);
+		const unsigned int nWindow = last - first + nTaps;
+		if (windowBuffer.size() < nWindow * voice.nChannels)
+		{
+			windowBuffer.resize(nWindow * voice.nChannels);
+		}
+		FetchFrames(voice, cache, (long long)first - (long long)nBefore, nWindow, windowBuffer.data());
+		Voice window = voice;
+		window.pSamples = windowBuffer.data();
+		window.nFrames = nWindow;
+		window.isLooping = false;
+		window.position = ((unsigned long long)nBefore << 32) | (voice.position & FracMask);
+		const unsigned long long start = window.position;
+		float* pFrames = pOut + nRendered * nOutputChannels;
+		if (interpolation == Interpolation::Linear)
+		{
+			if (voice.nChannels == 2u)
+			{
+				RenderVoice<short, 2u, Interpolation::Linear>(window, windowBuffer.data(), pFrames, nFrames);
+			}
+			else
+			{
+				RenderVoice<short, 1u, Interpolation::Linear>(window, windowBuffer.data(), pFrames, nFrames);
+			}
+		}
+		else if (voice.nChannels == 2u)
+		{
+			RenderVoice<short, 2u, Interpolation::Polyphase>(window, windowBuffer.data(), pFrames, nFrames);
+		}
+		else
+		{
+			RenderVoice<short, 1u, Interpolation::Polyphase>(window, windowBuffer.data(), pFrames, nFrames);
+		}
+		voice.position += window.position - start;
+		nRendered += nFrames;
+	}
+	return true;
+}
+
+void SoftwareMixer::FetchFrames(const Voice& voice, DecodeCache& cache, long long first, unsigned int n_frames, short* pOut) const
+{
+	const long long nFrames = (long long)voice.nFrames;
+	while (n_frames > 0u)
+	{
+		unsigned int count;
+		if (first >= 0 && first < nFrames)
+		{
+			count = (unsigned int)std::min<long long>(n_frames, nFrames - first);
+			DecodeCached(voice, cache, (UINT32)first, count, pOut);
+		}
+		else if (voice.isLooping)
+		{
+			first = ((first % nFrames) + nFrames) % nFrames;
+			continue;
+		}
+		else if (first < 0 || interpolation == Interpolation::Polyphase)
+		{
+			count = first < 0 ? (unsigned int)std::min<long long>(n_frames, -first) : n_frames;
+			std::fill(pOut, pOut + count * voice.nChannels, short(0));
+		}
+		else
+		{
+			// past the end of a one-shot sound linear interpolation holds the last frame, like the PCM path
+			count = n_frames;
+			for (unsigned int i = 0u; i < count * voice.nChannels; ++i)
+			{
+				pOut[i] = pOut[int(i) - int(voice.nChannels)];
+			}
+		}
+		pOut += count * voice.nChannels;
+		first += count;
+		n_frames -= count;
+	}
+}
+
+void SoftwareMixer::DecodeCached(const Voice& voice, DecodeCache& cache, UINT32 first, unsigned int n_frames, short* pOut) const
+{
+	const SoundBank::Entry& entry = *voice.pEntry;
+	const UINT32 firstBlock = first / entry.blockFrames;
+	const UINT32 lastBlock = (first + n_frames - 1u) / entry.blockFrames;
+	if (firstBlock < cache.firstBlock || lastBlock >= cache.firstBlock + cache.nBlocks)
+	{
+		// decode ahead so several blocks go through the vectorized decoder at once, keeping any still ahead of the read position
+		const UINT32 nBlocks = std::min(std::max(lastBlock - firstBlock + 1u, nReadAheadBlocks), entry.nBlocks - firstBlock);
+		const UINT32 nBlockSamples = entry.blockFrames * entry.nChannels;
+		if (cache.samples.size() < size_t(nBlocks) * nBlockSamples)
+		{
+			cache.samples.resize(size_t(nBlocks) * nBlockSamples);
+		}
+		UINT32 nKept = 0u;
+		if (firstBlock >= cache.firstBlock && firstBlock < cache.firstBlock + cache.nBlocks)
+		{
+			nKept = std::min(cache.firstBlock + cache.nBlocks - firstBlock, nBlocks);
+			memmove(cache.samples.data(), cache.samples.data() + size_t(firstBlock - cache.firstBlock) * nBlockSamples, size_t(nKept) * nBlockSamples * sizeof(short));
+		}
+		voice.pBank->DecodeBlocks(entry, firstBlock + nKept, nBlocks - nKept, cache.samples.data() + size_t(nKept) * nBlockSamples);
+		cache.firstBlock = firstBlock;
+		cache.nBlocks = nBlocks;
+	}
+	memcpy(pOut, cache.samples.data() + size_t(first - cache.firstBlock * entry.blockFrames) * entry.nChannels, size_t(n_frames) * entry.nChannels * sizeof(short));
+}
+
+void SoftwareMixer::Accumulate(float* pMix, const float* pVoice, unsigned int n_samples, float gain_left, float gain_right)
+{
+	const __m128 gain = _mm_setr_ps(gain_left, gain_right, gain_left, gain_right);
+	for (unsigned int i = 0u; i < n_samples; i += 4u)
+	{
+		_mm_storeu_ps(pMix + i, _mm_add_ps(_mm_loadu_ps(pMix + i), _mm_mul_ps(_mm_loadu_ps(pVoice + i), gain)));
+	}
+}
+
+const SoftwareMixer::FilterBank& SoftwareMixer::GetFilterBank()
+{
+	static const FilterBank bank = []()
+	{
+		FilterBank filters;
+		constexpr double pi = 3.14159265358979323846;
+		constexpr double halfWidth = double(nTaps / 2u);
+		for (unsigned int p = 0u; p < nPhases; ++p)
+		{
+			const double frac = double(p) / double(nPhases);
+			double sum = 0.0;
+			double coefs[nTaps];
+			for (unsigned int j = 0u; j < nTaps; ++j)
+			{
+				// windowed sinc evaluated at the distance of tap j from the fractional read position
+				const double x = double(j) - double(nTaps / 2u - 1u) - frac;
+				const double sinc = x == 0.0 ? 1.0 : std::sin(pi * x) / (pi * x);
+				const double window = 0.42 + 0.5 * std::cos(pi * x / halfWidth) + 0.08 * std::cos(2.0 * pi * x / halfWidth);
+				coefs[j] = sinc * window;
+				sum += coefs[j];
+			}
+			for (unsigned int j = 0u; j < nTaps; ++j)
+			{
+				filters.mono[p][j] = float(coefs[j] / sum);
+				filters.stereo[p][j * 2u] = filters.mono[p][j];
+				filters.stereo[p][j * 2u + 1u] = filters.mono[p][j];
+			}
+		}
+		return filters;
+	}();
+	return bank;
+}
+
+SoftwareMixer::SoftwareMixer(unsigned int sample_rate, unsigned int block_frames, unsigned int max_voices, Interpolation interpolation)
+	:
+	sampleRate(sample_rate),
+	blockFrames(block_frames),
+	interpolation(interpolation),
+	voices(max_voices),
+	mixBuffer(block_frames * nOutputChannels, 0.0f),
+	voiceBuffer(block_frames * nOutputChannels, 0.0f),
+	decodeCaches(max_voices),
+	windowBuffer((block_frames * 2u + nTaps) * nOutputChannels)
+{
+	assert(block_frames % 2u == 0u && "Block size must be a multiple of two frames");
+	for (DecodeCache& cache : decodeCaches)
+	{
+		cache.samples.reserve(nReadAheadBlocks * SoundBank::DefaultBlockFrames * nOutputChannels);
+	}
+}
+
+unsigned int SoftwareMixer::Play(const SoundBank& bank, const SoundBank::Entry& entry, float freqMod, float volume, bool loop)
+{
+	const unsigned int i = Play(nullptr, entry.nFrames, entry.nChannels, entry.sampleRate, SampleType::Int16, freqMod, volume, loop);
+	if (i != InvalidVoice)
+	{
+		voices[i].pBank = &bank;
+		voices[i].pEntry = &entry;
+		decodeCaches[i].nBlocks = 0u;
+	}
+	return i;
+}
+
+unsigned int SoftwareMixer::Play(const WaveFile& wave, float freqMod, float volume, bool loop)
+{
+	const WAVEFORMATEXTENSIBLE& format = wave.GetFormatExtensible();
+	const bool isFloatTag = format.Format.wFormatTag == WAVE_FORMAT_IEEE_FLOAT ||
+		(wave.IsExtensible() && format.SubFormat.Data1 == WAVE_FORMAT_IEEE_FLOAT);
+	const bool isPCMTag = format.Format.wFormatTag == WAVE_FORMAT_PCM ||
+		(wave.IsExtensible() && format.SubFormat.Data1 == WAVE_FORMAT_PCM);
+	SampleType type;
+	if (isPCMTag && format.Format.wBitsPerSample == 16u)
+	{
+		type = SampleType::Int16;
+	}
+	else if (isFloatTag && format.Format.wBitsPerSample == 32u)
+	{
+		type = SampleType::Float32;
+	}
+	else
+	{
+		throw SNDEXCPT("Software mixer only supports 16-bit PCM and 32-bit float sounds!");
+	}
+	if (format.Format.nChannels > nOutputChannels)
+	{
+		throw SNDEXCPT("Software mixer only supports mono and stereo sounds!");
+	}
+	return Play(wave.GetData(), wave.GetSampleCount(), format.Format.nChannels, format.Format.nSamplesPerSec, type, freqMod, volume, loop);
+}
+
+unsigned int SoftwareMixer::Play(const void* pSamples, unsigned int n_frames, unsigned int n_channels, unsigned int sample_rate, SampleType type, float freqMod, float volume, bool loop)
+{
+	assert(n_channels == 1u || n_channels == 2u);
+	if (n_frames == 0u)
+	{
+		return InvalidVoice;
+	}
+	for (unsigned int i = 0u; i < voices.size(); ++i)
+	{
+		Voice& voice = voices[i];
+		if (!voice.isActive)
+		{
+			voice.pSamples = pSamples;
+			voice.nFrames = n_frames;
+			voice.nChannels = n_channels;
+			voice.sampleRate = sample_rate;
+			voice.type = type;
+			voice.position = 0u;
+			voice.freqMod = freqMod;
+			voice.volume = volume;
+			voice.pan = 0.0f;
+			voice.isLooping = loop;
+			voice.isPaused = false;
+			voice.isActive = true;
+			voice.pBank = nullptr;
+			voice.pEntry = nullptr;
+			UpdateStep(voice);
+			++nActiveVoices;
+			return i;
+		}
+	}
+	return InvalidVoice;
+}
+
+void SoftwareMixer::Stop(unsigned int voice)
+{
+	assert(voice < voices.size());
+	if (voices[voice].isActive)
+	{
+		voices[voice].isActive = false;
+		--nActiveVoices;
+	}
+}
+
+void SoftwareMixer::StopAll()
+{
+	for (Voice& voice : voices)
+	{
+		voice.isActive = false;
+	}
+	nActiveVoices = 0u;
+}
+
+void SoftwareMixer::Pause(unsigned int voice)
+{
+	assert(voice < voices.size() && voices[voice].isActive);
+	voices[voice].isPaused = true;
+}
+
+void SoftwareMixer::Resume(unsigned int voice)
+{
+	assert(voice < voices.size() && voices[voice].isActive);
+	voices[voice].isPaused = false;
+}
+
+void SoftwareMixer::SetVolume(unsigned int voice, float volume)
+{
+	assert(voice < voices.size());
+	voices[voice].volume = volume;
+}
+
+void SoftwareMixer::SetPan(unsigned int voice, float pan)
+{
+	assert(voice < voices.size());
+	voices[voice].pan = std::min(std::max(pan, -1.0f), 1.0f);
+}
+
+void SoftwareMixer::SetFrequencyRatio(unsigned int voice, float freqMod)
+{
+	assert(voice < voices.size());
+	voices[voice].freqMod = freqMod;
+	UpdateStep(voices[voice]);
+}
+
+void SoftwareMixer::SetLooping(unsigned int voice, bool loop)
+{
+	assert(voice < voices.size());
+	voices[voice].isLooping = loop;
+}
+
+bool SoftwareMixer::IsPlaying(unsigned int voice) const
+{
+	assert(voice < voices.size());
+	return voices[voice].isActive && !voices[voice].isPaused;
+}
+
+void SoftwareMixer::SetInterpolation(Interpolation interpolation)
+{
+	this->interpolation = interpolation;
+}
+
+const SoftwareMixer::Interpolation& SoftwareMixer::GetInterpolation() const
+{
+	return interpolation;
+}
+
+void SoftwareMixer::SetSink(AudioSink* pSink)
+{
+	this->pSink = pSink;
+}
+
+const float* SoftwareMixer::Mix()
+{
+	std::fill(mixBuffer.begin(), mixBuffer.end(), 0.0f);
+	for (Voice& voice : voices)
+	{
+		if (!voice.isActive || voice.isPaused)
+		{
+			continue;
+		}
+		if (!RenderVoice(voice, voiceBuffer.data()))
+		{
+			--nActiveVoices;
+		}
+		const float gainLeft = voice.volume * std::min(1.0f, 1.0f - voice.pan);
+		const float gainRight = voice.volume * std::min(1.0f, 1.0f + voice.pan);
+		Accumulate(mixBuffer.data(), voiceBuffer.data(), blockFrames * nOutputChannels, gainLeft, gainRight);
+	}
+	if (pSink)
+	{
+		pSink->Write(mixBuffer.data(), blockFrames);
+	}
+	return mixBuffer.data();
+}
+
+void SoftwareMixer::Render(unsigned int n_blocks)
+{
+	for (unsigned int i = 0u; i < n_blocks; ++i)
+	{
+		Mix();
+	}
+}
+
+const unsigned int& SoftwareMixer::GetSampleRate() const
+{
+	return sampleRate;
+}
+
+const unsigned int& SoftwareMixer::GetBlockFrames() const
+{
+	return blockFrames;
+}
+
+unsigned int SoftwareMixer::GetActiveVoiceCount() const
+{
+	return nActiveVoices;
+}
+
+float SoftwareMixer::GetBlockLatency() const
+{
+	return float(blockFrames) / float(sampleRate);
+}
+
+SoftwareMixer::BenchmarkResult SoftwareMixer::Benchmark(unsigned int n_voices, float seconds, Interpolation interpolation, AudioSink* pSink, unsigned int block_frames)
+{
+	// one second of a stereo 44.1 kHz tone, played back at a spread of pitches so every voice resamples
+	constexpr unsigned int sourceRate = 44100u;
+	std::vector<short> tone(sourceRate * 2u);
+	for (unsigned int i = 0u; i < sourceRate; ++i)
+	{
+		const float t = float(i) / float(sourceRate);
+		tone[i * 2u] = short(std::sin(t * 440.0f * 6.2831853f) * 16000.0f);
+		tone[i * 2u + 1u] = short(std::sin(t * 660.0f * 6.2831853f) * 16000.0f);
+	}
+	SoftwareMixer mixer(48000u, block_frames, n_voices, interpolation);
+	NullSink nullSink;
+	mixer.SetSink(pSink ? pSink : &nullSink);
+	for (unsigned int i = 0u; i < n_voices; ++i)
+	{
+		const float freqMod = 0.5f + 1.5f * float(i) / float(std::max(n_voices, 1u));
+		mixer.Play(tone.data(), sourceRate, 2u, sourceRate, SampleType::Int16, freqMod, 1.0f / float(n_voices), true);
+	}
+	const unsigned int nBlocks = (unsigned int)std::ceil(seconds * float(mixer.GetSampleRate()) / float(block_frames));
+	BenchmarkResult result;
+	result.worstBlockTime = 0.0f;
+	Clock clock;
+	Clock blockClock;
+	for (unsigned int i = 0u; i < nBlocks; ++i)
+	{
+		blockClock.Mark();
+		mixer.Mix();
+		result.worstBlockTime = std::max(result.worstBlockTime, blockClock.Peek());
+	}
+	result.mixTime = clock.Peek();
+	result.nVoices = n_voices;
+	result.nFramesMixed = (unsigned long long)nBlocks * block_frames;
+	result.audioTime = float(result.nFramesMixed) / float(mixer.GetSampleRate());
+	result.realTimeFactor = result.mixTime > 0.0f ? result.audioTime / result.mixTime : 0.0f;
+	result.blockLatency = mixer.GetBlockLatency();
+	return result;
+}
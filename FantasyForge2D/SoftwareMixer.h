@@ -0,0 +1,115 @@
+#pragma once
+#include "AudioSink.h"
+#include "SoundBank.h"
+#include <vector>
+
+class SoftwareMixer
+{
+public:
+	enum class Interpolation
+	{
+		Linear,
+		Polyphase
+	};
+	enum class SampleType
+	{
+		Int16,
+		Float32
+	};
+	struct BenchmarkResult
+	{
+		float mixTime;
+		float audioTime;
+		float realTimeFactor;
+		float blockLatency;
+		float worstBlockTime;
+		unsigned int nVoices;
+		unsigned long long nFramesMixed;
+	};
+public:
+	static constexpr unsigned int nOutputChannels = 2u;
+	static constexpr unsigned int nTaps = 8u;
+	static constexpr unsigned int nPhases = 128u;
+	static constexpr unsigned int InvalidVoice = 0xFFFFFFFFu;
+	static constexpr unsigned int nReadAheadBlocks = 8u;
+private:
+	struct Voice
+	{
+		const void* pSamples = nullptr;
+		unsigned int nFrames = 0u;
+		unsigned int nChannels = 0u;
+		unsigned int sampleRate = 0u;
+		SampleType type = SampleType::Int16;
+		unsigned long long position = 0u;
+		unsigned long long step = 0u;
+		float freqMod = 1.0f;
+		float volume = 1.0f;
+		float pan = 0.0f;
+		bool isLooping = false;
+		bool isPaused = false;
+		bool isActive = false;
+		const SoundBank* pBank = nullptr;
+		const SoundBank::Entry* pEntry = nullptr;
+	};
+	struct DecodeCache
+	{
+		std::vector<short> samples;
+		UINT32 firstBlock = 0u;
+		UINT32 nBlocks = 0u;
+	};
+	struct FilterBank
+	{
+		alignas(16) float mono[nPhases][nTaps];
+		alignas(16) float stereo[nPhases][nTaps * 2u];
+	};
+private:
+	const unsigned int sampleRate;
+	const unsigned int blockFrames;
+	Interpolation interpolation;
+	std::vector<Voice> voices;
+	std::vector<float> mixBuffer;
+	std::vector<float> voiceBuffer;
+	std::vector<DecodeCache> decodeCaches;
+	std::vector<short> windowBuffer;
+	AudioSink* pSink = nullptr;
+	unsigned int nActiveVoices = 0u;
+private:
+	void UpdateStep(Voice& voice) const;
+	bool RenderVoice(Voice& voice, float* pOut);
+	template <typename T, unsigned int n_channels, Interpolation interp>
+	bool RenderVoice(Voice& voice, const T* pSamples, float* pOut, unsigned int n_frames) const;
+	bool RenderCompressed(Voice& voice, float* pOut);
+	void FetchFrames(const Voice& voice, DecodeCache& cache, long long first, unsigned int n_frames, short* pOut) const;
+	void DecodeCached(const Voice& voice, DecodeCache& cache, UINT32 first, unsigned int n_frames, short* pOut) const;
+	template <typename T, unsigned int n_channels>
+	static void FilterFrame(const Voice& voice, const T* pSamples, unsigned int index, unsigned int phase, float* pOut);
+	static void Accumulate(float* pMix, const float* pVoice, unsigned int n_samples, float gain_left, float gain_right);
+	static const FilterBank& GetFilterBank();
+public:
+	SoftwareMixer(unsigned int sample_rate = 48000u, unsigned int block_frames = 512u, unsigned int max_voices = 64u, Interpolation interpolation = Interpolation::Linear);
+	SoftwareMixer(const SoftwareMixer& mixer) = delete;
+	SoftwareMixer operator =(const SoftwareMixer& mixer) = delete;
+	unsigned int Play(const SoundBank& bank, const SoundBank::Entry& entry, float freqMod = 1.0f, float volume = 1.0f, bool loop = false);
+	unsigned int Play(const class WaveFile& wave, float freqMod = 1.0f, float volume = 1.0f, bool loop = false);
+	unsigned int Play(const void* pSamples, unsigned int n_frames, unsigned int n_channels, unsigned int sample_rate, SampleType type, float freqMod = 1.0f, float volume = 1.0f, bool loop = false);
+	void Stop(unsigned int voice);
+	void StopAll();
+	void Pause(unsigned int voice);
+	void Resume(unsigned int voice);
+	void SetVolume(unsigned int voice, float volume);
+	void SetPan(unsigned int voice, float pan);
+	void SetFrequencyRatio(unsigned int voice, float freqMod);
+	void SetLooping(unsigned int voice, bool loop);
+	bool IsPlaying(unsigned int voice) const;
+	void SetInterpolation(Interpolation interpolation);
+	const Interpolation& GetInterpolation() const;
+	void SetSink(AudioSink* pSink);
+	const float* Mix();
+	void Render(unsigned int n_blocks);
+	const unsigned int& GetSampleRate() const;
+	const unsigned int& GetBlockFrames() const;
+	unsigned int GetActiveVoiceCount() const;
+	float GetBlockLatency() const;
+public:
+	static BenchmarkResult Benchmark(unsigned int n_voices, float seconds, Interpolation interpolation = Interpolation::Linear, AudioSink* pSink = nullptr, unsigned int block_frames = 512u);
+};
@@ -1,92 +1,157 @@
 #include "Sound.h"
-#include <fstream>
+#include "SoundEmitter.h"
+#include <thread>
 
 void Sound::hasStarted(SoundSystem::Channel& channel)
 {
 	pChannels.push_back({ &channel,true });
 }
 
-void Sound::hasTerminated()
+void Sound::hasTerminated(SoundSystem::Channel& channel)
 {
-	pChannels.front() = { nullptr,false };
-	pChannels.erase(pChannels.begin());
+	for (auto it = pChannels.begin(); it != pChannels.end(); ++it)
+	{
+		if (it->first == &channel)
+		{
+			pChannels.erase(it);
+			return;
+		}
+	}
 }
 
-Sound::Sound(const char* fileName, float freqMod, float volume)
-	:
-	freqMod(freqMod),
-	volume(volume)
+void Sound::WaitForRelease() const
 {
-	std::ifstream wavIN{ fileName,std::ios::binary };
-	int riff = 0;
-	wavIN.read(reinterpret_cast<char*>(&riff), 4);
-	if (riff != 'FFIR')
+	while (pBuffersInFlight && *pBuffersInFlight > 0u)
 	{
-		throw SNDEXCPT("RIFF .wav sound files only!\n" + std::string(fileName));
+		std::this_thread::yield();
 	}
-	wavIN.seekg(4, std::ios::cur);
-	int wave = 0;
-	wavIN.read(reinterpret_cast<char*>(&wave), 4);
-	if (wave != 'EVAW')
+}
+
+void Sound::ConvertTo(const WAVEFORMATEXTENSIBLE& target, const char* fileName)
+{
+	const WAVEFORMATEXTENSIBLE& source = wave.GetFormatExtensible();
+	const WORD tag = wave.IsExtensible() ? WORD(source.SubFormat.Data1) : source.Format.wFormatTag;
+	const bool isShort = tag == WAVE_FORMAT_PCM && source.Format.wBitsPerSample == 16u;
+	const bool isFloat = tag == WAVE_FORMAT_IEEE_FLOAT && source.Format.wBitsPerSample == 32u;
+	const unsigned int nSrcChannels = source.Format.nChannels;
+	const unsigned int nDstChannels = target.Format.nChannels;
+	if ((!isShort && !isFloat) || nSrcChannels == 0u || nSrcChannels > 2u)
 	{
-		throw SNDEXCPT("Sound file must be of type .wav!\n" + std::string(fileName));
+		throw SNDEXCPT("Sound format cannot be converted to the canonical format!\n" + std::string(fileName));
 	}
-	int fmt = 0;
-	wavIN.read(reinterpret_cast<char*>(&fmt), 4);
-	if (fmt != ' tmf')
+	if (wave.GetSampleCount() == 0u)
 	{
-		throw SNDEXCPT("Format chunk of .wav file not found!\n" + std::string(fileName));
+		format = target;
+		nDataBytes = 0u;
+		return;
 	}
-	unsigned int fmtSize = 0;
-	wavIN.read(reinterpret_cast<char*>(&fmtSize), 4);
-	assert(fmtSize == 16);
-	format.cbSize = 0;
-	wavIN.read(reinterpret_cast<char*>(&format), fmtSize);
-	int data = 0;
-	bool foundData = false;
-	while (!foundData)
+	const BYTE* pSource = wave.GetData();
+	const UINT32 nSrcFrames = wave.GetSampleCount();
+	auto GetSample = [=](UINT32 frame, unsigned int channel)
+	{
+		const UINT32 index = frame * nSrcChannels + std::min(channel, nSrcChannels - 1u);
+		return isShort ? float(reinterpret_cast<const short*>(pSource)[index]) * (1.0f / 32768.0f) :
+			reinterpret_cast<const float*>(pSource)[index];
+	};
+	const double step = double(source.Format.nSamplesPerSec) / double(target.Format.nSamplesPerSec);
+	const UINT32 nDstFrames = std::max(UINT32(double(nSrcFrames) / step), 1u);
+	pConverted = std::make_unique<BYTE[]>(nDstFrames * target.Format.nBlockAlign);
+	short* pOut = reinterpret_cast<short*>(pConverted.get());
+	for (UINT32 f = 0u; f < nDstFrames; ++f)
 	{
-		char d = 0;
-		while (d != 'd')
+		const double position = double(f) * step;
+		const UINT32 i0 = std::min(UINT32(position), nSrcFrames - 1u);
+		const UINT32 i1 = std::min(i0 + 1u, nSrcFrames - 1u);
+		const float t = float(position - double(i0));
+		for (unsigned int c = 0u; c < nDstChannels; ++c)
 		{
-			wavIN.read(&d, 1);
-			if (wavIN.eof())
+			float value;
+			if (nDstChannels == 1u && nSrcChannels == 2u)
 			{
-				throw SNDEXCPT("Data chunk of .wav file not found!\n" + std::string(fileName));
-				break;
+				value = 0.5f * ((GetSample(i0, 0u) + GetSample(i0, 1u)) * (1.0f - t) + (GetSample(i1, 0u) + GetSample(i1, 1u)) * t);
 			}
+			else
+			{
+				value = GetSample(i0, c) * (1.0f - t) + GetSample(i1, c) * t;
+			}
+			pOut[f * nDstChannels + c] = short(std::lround(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f));
 		}
-		wavIN.seekg(-1, std::ios::cur);
-		wavIN.read(reinterpret_cast<char*>(&data), 4);
-		foundData = (data == 'atad');
-		if (!foundData)
-		{
-			wavIN.seekg(-3, std::ios::cur);
-		}
 	}
-	wavIN.read(reinterpret_cast<char*>(&nSoundBytes), 4);
-	pSoundData = std::make_unique<BYTE[]>(nSoundBytes);
-	wavIN.read(reinterpret_cast<char*>(pSoundData.get()), nSoundBytes);
+	format = target;
+	pData = pConverted.get();
+	nDataBytes = nDstFrames * target.Format.nBlockAlign;
+}
+
+Sound::Sound(const char* fileName, float freqMod, float volume, int priority)
+	:
+	wave(fileName),
+	format(wave.GetFormatExtensible()),
+	pData(wave.GetData()),
+	nDataBytes(wave.GetDataSize()),
+	freqMod(freqMod),
+	volume(volume),
+	priority(priority),
+	pBuffersInFlight(std::make_unique<std::atomic<unsigned int>>(0u))
+{
+	SoundSystem& soundSys = SoundSystem::Get();
+	const std::optional<WAVEFORMATEXTENSIBLE>& canonical = soundSys.GetCanonicalFormat();
+	if (canonical && !SoundSystem::SoundFmtsAreEqual(format, *canonical))
+	{
+		ConvertTo(*canonical, fileName);
+	}
+	bucket = soundSys.RegisterFormat(format);
 }
 
 Sound::Sound(Sound&& sound) noexcept
 	:
+	wave(std::move(sound.wave)),
+	pConverted(std::move(sound.pConverted)),
 	format(sound.format),
-	nSoundBytes(sound.nSoundBytes),
-	pSoundData(std::move(sound.pSoundData)),
+	pData(sound.pData),
+	nDataBytes(sound.nDataBytes),
+	bucket(sound.bucket),
 	pChannels(std::move(sound.pChannels)),
 	freqMod(sound.freqMod),
-	volume(sound.volume)
-{}
+	volume(sound.volume),
+	priority(sound.priority),
+	nVirtualInstances(sound.nVirtualInstances),
+	pBuffersInFlight(std::move(sound.pBuffersInFlight))
+{
+	sound.pChannels.clear();
+	sound.nVirtualInstances = 0u;
+	SoundSystem::Get().RetargetSound(sound, *this);
+}
 
 void Sound::Start()
 {
-	SoundSystem::Get().StartSound(*this, freqMod, volume);
+	SoundSystem::Get().StartSound(*this, freqMod, volume, priority);
+}
+
+void Sound::Start(const SoundEmitter& emitter)
+{
+	SoundSystem::Get().StartSound(*this, freqMod, volume, priority, emitter.GetID());
+}
+
+void Sound::StartAt(UINT64 sample_time)
+{
+	SoundSystem::Get().ScheduleSound(*this, sample_time, freqMod, volume, priority);
+}
+
+void Sound::StartAt(UINT64 sample_time, const SoundEmitter& emitter)
+{
+	SoundSystem::Get().ScheduleSound(*this, sample_time, freqMod, volume, priority, emitter.GetID());
 }
 
 void Sound::Stop()
 {
-	pChannels.front().first->StopSound();
+	if (!pChannels.empty())
+	{
+		pChannels.front().first->StopSound();
+	}
+	else if (nVirtualInstances > 0u)
+	{
+		SoundSystem::Get().StopVirtual(*this, false);
+	}
 }
 
 void Sound::Resume(int instance)
@@ -153,6 +218,52 @@ const float& Sound::GetVolume() const
 	return volume;
 }
 
+void Sound::SetPriority(int priority)
+{
+	this->priority = priority;
+}
+
+const int& Sound::GetPriority() const
+{
+	return priority;
+}
+
+const unsigned int& Sound::GetVirtualInstanceCount() const
+{
+	return nVirtualInstances;
+}
+
+const WAVEFORMATEXTENSIBLE& Sound::GetFormat() const
+{
+	return format;
+}
+
+const BYTE* Sound::GetData() const
+{
+	return pData;
+}
+
+const UINT32& Sound::GetDataSize() const
+{
+	return nDataBytes;
+}
+
+UINT32 Sound::GetSampleCount() const
+{
+	return nDataBytes / format.Format.nBlockAlign;
+}
+
+bool Sound::IsConverted() const
+{
+	return pConverted != nullptr;
+}
+
+double Sound::GetPlaybackPosition(int instance) const
+{
+	assert(instance < pChannels.size());
+	return pChannels[instance].first->GetPlaybackPosition();
+}
+
 const bool& Sound::isActivelyPlaying(int instance) const
 {
 	assert(instance < pChannels.size());
@@ -174,11 +285,12 @@ bool Sound::isActivelyPlayingAny() const
 
 bool Sound::isPlaying() const
 {
-	return !pChannels.empty();
+	return !pChannels.empty() || nVirtualInstances > 0u;
 }
 
 Sound::~Sound()
 {
 	StopAll();
+	WaitForRelease();
 }
 
@@ -1,26 +1,38 @@
 #pragma once
 #include "SoundSystem.h"
+#include "WaveFile.h"
 #include <assert.h>
 
 class Sound
 {
 	friend SoundSystem;
 private:
-	WAVEFORMATEX format;
-	UINT32 nSoundBytes;
-	std::unique_ptr<BYTE[]> pSoundData;
+	WaveFile wave;
+	std::unique_ptr<BYTE[]> pConverted;
+	WAVEFORMATEXTENSIBLE format;
+	const BYTE* pData;
+	UINT32 nDataBytes;
+	unsigned int bucket;
 	std::vector<std::pair<SoundSystem::Channel*, bool>> pChannels;
 	float freqMod;
 	float volume;
+	int priority;
+	unsigned int nVirtualInstances = 0u;
+	std::unique_ptr<std::atomic<unsigned int>> pBuffersInFlight;
 private:
 	void hasStarted(SoundSystem::Channel& channel);
-	void hasTerminated();
+	void hasTerminated(SoundSystem::Channel& channel);
+	void WaitForRelease() const;
+	void ConvertTo(const WAVEFORMATEXTENSIBLE& target, const char* fileName);
 public:
-	Sound(const char* fileName, float freqMod = 1.0f, float volume = 1.0f);
+	Sound(const char* fileName, float freqMod = 1.0f, float volume = 1.0f, int priority = 0);
 	Sound(const Sound& sound) = delete;
 	Sound operator =(const Sound& sound) = delete;
 	Sound(Sound&& sound) noexcept;
 	void Start();
+	void Start(const class SoundEmitter& emitter);
+	void StartAt(UINT64 sample_time);
+	void StartAt(UINT64 sample_time, const class SoundEmitter& emitter);
 	void Stop();
 	void Resume(int instance);
 	void Pause(int instance);
@@ -29,6 +41,15 @@ public:
 	void ResumeAll();
 	void SetVolume(float volume);
 	const float& GetVolume() const;
+	void SetPriority(int priority);
+	const int& GetPriority() const;
+	const unsigned int& GetVirtualInstanceCount() const;
+	const WAVEFORMATEXTENSIBLE& GetFormat() const;
+	const BYTE* GetData() const;
+	const UINT32& GetDataSize() const;
+	UINT32 GetSampleCount() const;
+	bool IsConverted() const;
+	double GetPlaybackPosition(int instance) const;
 	const bool& isActivelyPlaying(int instance) const;
 	bool isActivelyPlayingAny() const;
 	bool isPlaying() const;
@@ -0,0 +1,455 @@
+#include "SoundBank.h"
+#include "WaveFile.h"
+#include <algorithm>
+#include <fstream>
+#include <emmintrin.h>
+
+static constexpr int StepTable[89] =
+{
+	7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+	130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060,
+	1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484,
+	7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+static constexpr int MaxStepIndex = 88;
+
+static int IndexAdjust(int code)
+{
+	const int magnitude = code & 7;
+	return magnitude < 4 ? -1 : (magnitude - 3) * 2;
+}
+
+static int StepDelta(int code, int step)
+{
+	int delta = step >> 3;
+	if (code & 4)
+	{
+		delta += step;
+	}
+	if (code & 2)
+	{
+		delta += step >> 1;
+	}
+	if (code & 1)
+	{
+		delta += step >> 2;
+	}
+	return (code & 8) ? -delta : delta;
+}
+
+void SoundBank::Release()
+{
+	if (pView)
+	{
+		UnmapViewOfFile(pView);
+		pView = nullptr;
+	}
+	fileSize = 0u;
+	pEntries = nullptr;
+	nEntries = 0u;
+}
+
+void SoundBank::DecodeStream(const BYTE* pHeader, const BYTE* pCodes, UINT32 n_frames, UINT32 n_channels, short* pOut)
+{
+	INT16 header;
+	memcpy(&header, pHeader, 2u);
+	int predictor = header;
+	int stepIndex = std::min(int(pHeader[2]), MaxStepIndex);
+	for (UINT32 f = 0u; f < n_frames; ++f)
+	{
+		const int code = (pCodes[f >> 1] >> ((f & 1u) * 4u)) & 0xF;
+		predictor = std::min(std::max(predictor + StepDelta(code, StepTable[stepIndex]), -32768), 32767);
+		stepIndex = std::min(std::max(stepIndex + IndexAdjust(code), 0), MaxStepIndex);
+		pOut[f * n_channels] = short(predictor);
+	}
+}
+
+template <UINT32 n_channels>
+void SoundBank::DecodeGroup(const BYTE* const pHeaders[4], const BYTE* const pCodes[4], UINT32 n_frames, short* const pOut[4])
+{
+	// four independent streams decode side by side in the lanes; for stereo the lanes hold L,R of two consecutive blocks
+	alignas(16) int lanes[4];
+	for (unsigned int l = 0u; l < 4u; ++l)
+	{
+		INT16 header;
+		memcpy(&header, pHeaders[l], 2u);
+		lanes[l] = header;
+	}
+	__m128i predictor = _mm_load_si128(reinterpret_cast<const __m128i*>(lanes));
+	for (unsigned int l = 0u; l < 4u; ++l)
+	{
+		lanes[l] = std::min(int(pHeaders[l][2]), MaxStepIndex);
+	}
+	__m128i stepIndex = _mm_load_si128(reinterpret_cast<const __m128i*>(lanes));
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128i two = _mm_set1_epi32(2);
+	const __m128i three = _mm_set1_epi32(3);
+	const __m128i four = _mm_set1_epi32(4);
+	const __m128i seven = _mm_set1_epi32(7);
+	const __m128i eight = _mm_set1_epi32(8);
+	const __m128i nibble = _mm_set1_epi32(0xF);
+	const __m128i minusOne = _mm_set1_epi32(-1);
+	const __m128i maxIndex = _mm_set1_epi32(MaxStepIndex);
+	for (UINT32 f = 0u; f < n_frames; f += 8u)
+	{
+		UINT32 words[4];
+		for (unsigned int l = 0u; l < 4u; ++l)
+		{
+			memcpy(&words[l], pCodes[l] + f / 2u, 4u);
+		}
+		__m128i codes = _mm_setr_epi32(int(words[0]), int(words[1]), int(words[2]), int(words[3]));
+		__m128i decoded[8];
+		for (unsigned int k = 0u; k < 8u; ++k)
+		{
+			const __m128i code = _mm_and_si128(codes, nibble);
+			codes = _mm_srli_epi32(codes, 4);
+			_mm_store_si128(reinterpret_cast<__m128i*>(lanes), stepIndex);
+			const __m128i step = _mm_setr_epi32(StepTable[lanes[0]], StepTable[lanes[1]], StepTable[lanes[2]], StepTable[lanes[3]]);
+			__m128i delta = _mm_srai_epi32(step, 3);
+			delta = _mm_add_epi32(delta, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(code, four), four), step));
+			delta = _mm_add_epi32(delta, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(code, two), two), _mm_srai_epi32(step, 1)));
+			delta = _mm_add_epi32(delta, _mm_and_si128(_mm_cmpeq_epi32(_mm_and_si128(code, one), one), _mm_srai_epi32(step, 2)));
+			const __m128i sign = _mm_cmpeq_epi32(_mm_and_si128(code, eight), eight);
+			delta = _mm_sub_epi32(_mm_xor_si128(delta, sign), sign);
+			// saturating to 16 bits and widening back keeps the predictor in range without SSE4 min/max
+			const __m128i sum = _mm_packs_epi32(_mm_add_epi32(predictor, delta), _mm_setzero_si128());
+			predictor = _mm_srai_epi32(_mm_unpacklo_epi16(sum, sum), 16);
+			decoded[k] = predictor;
+			const __m128i magnitude = _mm_and_si128(code, seven);
+			const __m128i isLarge = _mm_cmpgt_epi32(magnitude, three);
+			const __m128i adjust = _mm_or_si128(_mm_and_si128(isLarge, _mm_slli_epi32(_mm_sub_epi32(magnitude, three), 1)), _mm_andnot_si128(isLarge, minusOne));
+			stepIndex = _mm_add_epi32(stepIndex, adjust);
+			stepIndex = _mm_and_si128(stepIndex, _mm_cmpgt_epi32(stepIndex, minusOne));
+			const __m128i isOver = _mm_cmpgt_epi32(stepIndex, maxIndex);
+			stepIndex = _mm_or_si128(_mm_and_si128(isOver, maxIndex), _mm_andnot_si128(isOver, stepIndex));
+		}
+		// transpose the 8 samples x 4 lanes into one row of 8 shorts per lane
+		const __m128i p01 = _mm_packs_epi32(decoded[0], decoded[1]);
+		const __m128i p23 = _mm_packs_epi32(decoded[2], decoded[3]);
+		const __m128i p45 = _mm_packs_epi32(decoded[4], decoded[5]);
+		const __m128i p67 = _mm_packs_epi32(decoded[6], decoded[7]);
+		const __m128i x0 = _mm_unpacklo_epi16(p01, _mm_srli_si128(p01, 8));
+		const __m128i x1 = _mm_unpacklo_epi16(p23, _mm_srli_si128(p23, 8));
+		const __m128i x2 = _mm_unpacklo_epi16(p45, _mm_srli_si128(p45, 8));
+		const __m128i x3 = _mm_unpacklo_epi16(p67, _mm_srli_si128(p67, 8));
+		const __m128i y0 = _mm_unpacklo_epi32(x0, x1);
+		const __m128i y1 = _mm_unpackhi_epi32(x0, x1);
+		const __m128i y2 = _mm_unpacklo_epi32(x2, x3);
+		const __m128i y3 = _mm_unpackhi_epi32(x2, x3);
+		const __m128i rows[4] =
+		{
+			_mm_unpacklo_epi64(y0, y2),
+			_mm_unpackhi_epi64(y0, y2),
+			_mm_unpacklo_epi64(y1, y3),
+			_mm_unpackhi_epi64(y1, y3)
+		};
+		if constexpr (n_channels == 2u)
+		{
+			for (unsigned int l = 0u; l < 4u; l += 2u)
+			{
+				__m128i* pDest = reinterpret_cast<__m128i*>(pOut[l] + f * 2u);
+				_mm_storeu_si128(pDest, _mm_unpacklo_epi16(rows[l], rows[l + 1u]));
+				_mm_storeu_si128(pDest + 1, _mm_unpackhi_epi16(rows[l], rows[l + 1u]));
+			}
+		}
+		else
+		{
+			for (unsigned int l = 0u; l < 4u; ++l)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pOut[l] + f), rows[l]);
+			}
+		}
+	}
+}
+
+void SoundBank::EncodeStream(const short* pSamples, UINT32 n_frames, UINT32 n_channels, int& stepIndex, BYTE* pHeader, BYTE* pCodes)
+{
+	// every block reseeds the predictor from its first sample so errors never carry across block boundaries;
+	// the header only seeds the decoder, so the first sample still goes out as a code like the rest
+	int predictor = pSamples[0];
+	const INT16 header = INT16(predictor);
+	memcpy(pHeader, &header, 2u);
+	pHeader[2] = BYTE(stepIndex);
+	pHeader[3] = 0u;
+	memset(pCodes, 0, n_frames / 2u);
+	for (UINT32 f = 0u; f < n_frames; ++f)
+	{
+		const int step = StepTable[stepIndex];
+		int diff = int(pSamples[f * n_channels]) - predictor;
+		int code = 0;
+		if (diff < 0)
+		{
+			code = 8;
+			diff = -diff;
+		}
+		if (diff >= step)
+		{
+			code |= 4;
+			diff -= step;
+		}
+		if (diff >= step >> 1)
+		{
+			code |= 2;
+			diff -= step >> 1;
+		}
+		if (diff >= step >> 2)
+		{
+			code |= 1;
+		}
+		// track exactly what the decoder will reconstruct
+		predictor = std::min(std::max(predictor + StepDelta(code, step), -32768), 32767);
+		stepIndex = std::min(std::max(stepIndex + IndexAdjust(code), 0), MaxStepIndex);
+		pCodes[f >> 1] |= BYTE(code << ((f & 1u) * 4u));
+	}
+}
+
+SoundBank::SoundBank(const char* fileName)
+{
+	HANDLE hFile = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		throw SNDEXCPT_NOTE(HRESULT_FROM_WIN32(GetLastError()), "Could not open sound bank!\n" + std::string(fileName));
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(hFile, &size) || size.QuadPart < LONGLONG(sizeof(Header)))
+	{
+		CloseHandle(hFile);
+		throw SNDEXCPT("Invalid sound bank!\n" + std::string(fileName));
+	}
+	fileSize = size_t(size.QuadPart);
+	HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0u, 0u, nullptr);
+	CloseHandle(hFile);
+	if (!hMapping)
+	{
+		throw SNDEXCPT_NOTE(HRESULT_FROM_WIN32(GetLastError()), "Could not map sound bank!\n" + std::string(fileName));
+	}
+	pView = static_cast<const BYTE*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0u, 0u, 0u));
+	CloseHandle(hMapping);
+	if (!pView)
+	{
+		throw SNDEXCPT_NOTE(HRESULT_FROM_WIN32(GetLastError()), "Could not map sound bank!\n" + std::string(fileName));
+	}
+	Header header;
+	memcpy(&header, pView, sizeof(Header));
+	if (header.id != BankID || header.version != Version ||
+		fileSize < sizeof(Header) + size_t(header.nEntries) * sizeof(Entry))
+	{
+		Release();
+		throw SNDEXCPT("Invalid sound bank!\n" + std::string(fileName));
+	}
+	pEntries = reinterpret_cast<const Entry*>(pView + sizeof(Header));
+	nEntries = header.nEntries;
+	for (UINT32 i = 0u; i < nEntries; ++i)
+	{
+		const Entry& entry = pEntries[i];
+		const bool isValid =
+			(entry.nChannels == 1u || entry.nChannels == 2u) &&
+			entry.blockFrames > 0u && entry.blockFrames % 8u == 0u &&
+			entry.blockBytes == entry.nChannels * (BlockHeaderSize + entry.blockFrames / 2u) &&
+			entry.nBlocks == (entry.nFrames + entry.blockFrames - 1u) / entry.blockFrames &&
+			size_t(entry.dataOffset) + size_t(entry.nBlocks) * entry.blockBytes <= fileSize;
+		if (!isValid)
+		{
+			Release();
+			throw SNDEXCPT("Corrupt sound bank entry!\n" + std::string(fileName));
+		}
+	}
+}
+
+const SoundBank::Entry* SoundBank::Find(const char* name) const
+{
+	const UINT32 hash = HashName(name);
+	const Entry* pEnd = pEntries + nEntries;
+	const Entry* pEntry = std::lower_bound(pEntries, pEnd, hash, [](const Entry& entry, UINT32 hash)
+		{
+			return entry.nameHash < hash;
+		});
+	return pEntry != pEnd && pEntry->nameHash == hash ? pEntry : nullptr;
+}
+
+const SoundBank::Entry& SoundBank::GetEntry(UINT32 index) const
+{
+	assert(index < nEntries);
+	return pEntries[index];
+}
+
+const UINT32& SoundBank::GetEntryCount() const
+{
+	return nEntries;
+}
+
+const BYTE* SoundBank::GetBlock(const Entry& entry, UINT32 block) const
+{
+	assert(block < entry.nBlocks);
+	return pView + entry.dataOffset + size_t(block) * entry.blockBytes;
+}
+
+void SoundBank::DecodeBlocks(const Entry& entry, UINT32 first_block, UINT32 n_blocks, short* pOut) const
+{
+	assert(first_block + n_blocks <= entry.nBlocks);
+	const UINT32 nStreams = n_blocks * entry.nChannels;
+	const UINT32 nCodeBytes = entry.blockFrames / 2u;
+	const UINT32 nBlockSamples = entry.blockFrames * entry.nChannels;
+	const BYTE* pHeaders[4];
+	const BYTE* pCodes[4];
+	short* pDest[4];
+	UINT32 s = 0u;
+	for (; s + 4u <= nStreams; s += 4u)
+	{
+		for (UINT32 l = 0u; l < 4u; ++l)
+		{
+			const UINT32 block = (s + l) / entry.nChannels;
+			const UINT32 channel = (s + l) % entry.nChannels;
+			const BYTE* pBlock = GetBlock(entry, first_block + block);
+			pHeaders[l] = pBlock + channel * BlockHeaderSize;
+			pCodes[l] = pBlock + entry.nChannels * BlockHeaderSize + channel * nCodeBytes;
+			pDest[l] = pOut + block * nBlockSamples + channel;
+		}
+		if (entry.nChannels == 2u)
+		{
+			DecodeGroup<2u>(pHeaders, pCodes, entry.blockFrames, pDest);
+		}
+		else
+		{
+			DecodeGroup<1u>(pHeaders, pCodes, entry.blockFrames, pDest);
+		}
+	}
+	for (; s < nStreams; ++s)
+	{
+		const UINT32 block = s / entry.nChannels;
+		const UINT32 channel = s % entry.nChannels;
+		const BYTE* pBlock = GetBlock(entry, first_block + block);
+		DecodeStream(pBlock + channel * BlockHeaderSize, pBlock + entry.nChannels * BlockHeaderSize + channel * nCodeBytes,
+			entry.blockFrames, entry.nChannels, pOut + block * nBlockSamples + channel);
+	}
+}
+
+void SoundBank::Decode(const Entry& entry, UINT32 first_frame, UINT32 n_frames, short* pOut) const
+{
+	assert(first_frame + n_frames <= entry.nFrames);
+	if (n_frames == 0u)
+	{
+		return;
+	}
+	const UINT32 firstBlock = first_frame / entry.blockFrames;
+	const UINT32 lastBlock = (first_frame + n_frames - 1u) / entry.blockFrames;
+	const UINT32 nBlocks = lastBlock - firstBlock + 1u;
+	const UINT32 offset = first_frame - firstBlock * entry.blockFrames;
+	if (offset == 0u && n_frames == nBlocks * entry.blockFrames)
+	{
+		DecodeBlocks(entry, firstBlock, nBlocks, pOut);
+		return;
+	}
+	std::vector<short> decoded(size_t(nBlocks) * entry.blockFrames * entry.nChannels);
+	DecodeBlocks(entry, firstBlock, nBlocks, decoded.data());
+	memcpy(pOut, decoded.data() + size_t(offset) * entry.nChannels, size_t(n_frames) * entry.nChannels * sizeof(short));
+}
+
+const size_t& SoundBank::GetSize() const
+{
+	return fileSize;
+}
+
+SoundBank::~SoundBank()
+{
+	Release();
+}
+
+UINT32 SoundBank::HashName(const char* name)
+{
+	// FNV-1a over the lower-cased path with unified separators
+	UINT32 hash = 2166136261u;
+	for (const char* p = name; *p; ++p)
+	{
+		char c = *p == '\\' ? '/' : *p;
+		if (c >= 'A' && c <= 'Z')
+		{
+			c = c - 'A' + 'a';
+		}
+		hash = (hash ^ BYTE(c)) * 16777619u;
+	}
+	return hash;
+}
+
+void SoundBank::Build(const std::vector<std::string>& wavFiles, const char* bankFile, UINT32 block_frames)
+{
+	assert(block_frames > 0u && block_frames % 8u == 0u && "Block size must be a multiple of eight frames");
+	std::vector<std::pair<Entry, std::vector<BYTE>>> encoded;
+	encoded.reserve(wavFiles.size());
+	for (const std::string& fileName : wavFiles)
+	{
+		const WaveFile wave(fileName.c_str());
+		const WAVEFORMATEXTENSIBLE& format = wave.GetFormatExtensible();
+		const bool isPCMTag = format.Format.wFormatTag == WAVE_FORMAT_PCM ||
+			(wave.IsExtensible() && format.SubFormat.Data1 == WAVE_FORMAT_PCM);
+		if (!isPCMTag || format.Format.wBitsPerSample != 16u || format.Format.nChannels < 1u || format.Format.nChannels > 2u)
+		{
+			throw SNDEXCPT("Sound banks only support 16-bit PCM mono and stereo sounds!\n" + fileName);
+		}
+		Entry entry;
+		entry.nameHash = HashName(fileName.c_str());
+		entry.sampleRate = format.Format.nSamplesPerSec;
+		entry.nChannels = format.Format.nChannels;
+		entry.nFrames = wave.GetSampleCount();
+		entry.blockFrames = block_frames;
+		entry.nBlocks = (entry.nFrames + block_frames - 1u) / block_frames;
+		entry.blockBytes = entry.nChannels * (BlockHeaderSize + block_frames / 2u);
+		entry.dataOffset = 0u;
+		std::vector<BYTE> data(size_t(entry.nBlocks) * entry.blockBytes);
+		std::vector<short> block(size_t(block_frames) * entry.nChannels);
+		int stepIndices[2] = { 0, 0 };
+		for (UINT32 b = 0u; b < entry.nBlocks; ++b)
+		{
+			// the tail of the last block is padded with silence; nFrames keeps it from ever being played
+			const UINT32 nFrames = std::min(block_frames, entry.nFrames - b * block_frames);
+			std::fill(block.begin(), block.end(), short(0));
+			memcpy(block.data(), wave.GetData() + size_t(b) * block_frames * format.Format.nBlockAlign, size_t(nFrames) * format.Format.nBlockAlign);
+			BYTE* pBlock = data.data() + size_t(b) * entry.blockBytes;
+			for (UINT32 c = 0u; c < entry.nChannels; ++c)
+			{
+				EncodeStream(block.data() + c, block_frames, entry.nChannels, stepIndices[c],
+					pBlock + c * BlockHeaderSize, pBlock + entry.nChannels * BlockHeaderSize + c * (block_frames / 2u));
+			}
+		}
+		encoded.emplace_back(entry, std::move(data));
+	}
+	std::sort(encoded.begin(), encoded.end(), [](const auto& left, const auto& right)
+		{
+			return left.first.nameHash < right.first.nameHash;
+		});
+	for (size_t i = 1u; i < encoded.size(); ++i)
+	{
+		if (encoded[i].first.nameHash == encoded[i - 1u].first.nameHash)
+		{
+			throw SNDEXCPT("Duplicate or colliding sound names in sound bank!\n" + std::string(bankFile));
+		}
+	}
+	size_t offset = sizeof(Header) + encoded.size() * sizeof(Entry);
+	for (auto& e : encoded)
+	{
+		offset = (offset + DataAlignment - 1u) / DataAlignment * DataAlignment;
+		e.first.dataOffset = UINT32(offset);
+		offset += e.second.size();
+	}
+	std::ofstream bankOUT(bankFile, std::ios::binary);
+	if (!bankOUT)
+	{
+		throw SNDEXCPT("Could not create sound bank!\n" + std::string(bankFile));
+	}
+	const Header header = { BankID, Version, UINT32(encoded.size()), block_frames };
+	bankOUT.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (const auto& e : encoded)
+	{
+		bankOUT.write(reinterpret_cast<const char*>(&e.first), sizeof(Entry));
+	}
+	const char padding[DataAlignment] = {};
+	for (const auto& e : encoded)
+	{
+		bankOUT.write(padding, std::streamsize(e.first.dataOffset - size_t(bankOUT.tellp())));
+		bankOUT.write(reinterpret_cast<const char*>(e.second.data()), std::streamsize(e.second.size()));
+	}
+	if (!bankOUT)
+	{
+		throw SNDEXCPT("Could not write sound bank!\n" + std::string(bankFile));
+	}
+}
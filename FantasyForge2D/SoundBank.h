@@ -0,0 +1,61 @@
+#pragma once
+#include "SoundSystem.h"
+#include <string>
+#include <vector>
+
+class SoundBank
+{
+public:
+	struct Header
+	{
+		UINT32 id;
+		UINT32 version;
+		UINT32 nEntries;
+		UINT32 blockFrames;
+	};
+	// entries are stored sorted by name hash so lookups are a binary search over the table
+	struct Entry
+	{
+		UINT32 nameHash;
+		UINT32 sampleRate;
+		UINT32 nChannels;
+		UINT32 nFrames;
+		UINT32 nBlocks;
+		UINT32 blockFrames;
+		UINT32 blockBytes;
+		UINT32 dataOffset;
+	};
+public:
+	static constexpr UINT32 BankID = 'BSFF';
+	static constexpr UINT32 Version = 1u;
+	static constexpr UINT32 DefaultBlockFrames = 256u;
+	static constexpr UINT32 BlockHeaderSize = 4u;
+	static constexpr UINT32 DataAlignment = 16u;
+private:
+	const BYTE* pView = nullptr;
+	size_t fileSize = 0u;
+	const Entry* pEntries = nullptr;
+	UINT32 nEntries = 0u;
+private:
+	void Release();
+	static void DecodeStream(const BYTE* pHeader, const BYTE* pCodes, UINT32 n_frames, UINT32 n_channels, short* pOut);
+	template <UINT32 n_channels>
+	static void DecodeGroup(const BYTE* const pHeaders[4], const BYTE* const pCodes[4], UINT32 n_frames, short* const pOut[4]);
+	static void EncodeStream(const short* pSamples, UINT32 n_frames, UINT32 n_channels, int& stepIndex, BYTE* pHeader, BYTE* pCodes);
+public:
+	SoundBank() = delete;
+	SoundBank(const char* fileName);
+	SoundBank(const SoundBank& bank) = delete;
+	SoundBank operator =(const SoundBank& bank) = delete;
+	const Entry* Find(const char* name) const;
+	const Entry& GetEntry(UINT32 index) const;
+	const UINT32& GetEntryCount() const;
+	const BYTE* GetBlock(const Entry& entry, UINT32 block) const;
+	void DecodeBlocks(const Entry& entry, UINT32 first_block, UINT32 n_blocks, short* pOut) const;
+	void Decode(const Entry& entry, UINT32 first_frame, UINT32 n_frames, short* pOut) const;
+	const size_t& GetSize() const;
+	~SoundBank();
+public:
+	static UINT32 HashName(const char* name);
+	static void Build(const std::vector<std::string>& wavFiles, const char* bankFile, UINT32 block_frames = DefaultBlockFrames);
+};
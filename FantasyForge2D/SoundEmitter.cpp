@@ -0,0 +1,81 @@
+#include "SoundEmitter.h"
+#include "Sound.h"
+
+SoundEmitter::SoundEmitter(vec2 position, float volume)
+	:
+	id(SoundSystem::Get().CreateEmitter(position.x, position.y, volume)),
+	position(position),
+	volume(volume)
+{}
+
+SoundEmitter::SoundEmitter(SoundEmitter&& emitter) noexcept
+	:
+	id(emitter.id),
+	position(emitter.position),
+	volume(emitter.volume)
+{
+	emitter.id = SoundSystem::NoEmitter;
+}
+
+void SoundEmitter::Play(Sound& sound)
+{
+	assert(id != SoundSystem::NoEmitter);
+	sound.Start(*this);
+}
+
+void SoundEmitter::SetPosition(vec2 pos)
+{
+	assert(id != SoundSystem::NoEmitter);
+	// only the stored position changes here; attenuation is recomputed for all emitters at once in SoundSystem::Update
+	position = pos;
+	SoundSystem& soundSys = SoundSystem::Get();
+	soundSys.emitterX[id] = pos.x;
+	soundSys.emitterY[id] = pos.y;
+}
+
+void SoundEmitter::Move(vec2 delta)
+{
+	SetPosition(position + delta);
+}
+
+const vec2& SoundEmitter::GetPosition() const
+{
+	return position;
+}
+
+void SoundEmitter::SetVolume(float volume)
+{
+	assert(id != SoundSystem::NoEmitter);
+	this->volume = volume;
+	SoundSystem::Get().emitterVolume[id] = volume;
+}
+
+const float& SoundEmitter::GetVolume() const
+{
+	return volume;
+}
+
+float SoundEmitter::GetGain() const
+{
+	assert(id != SoundSystem::NoEmitter);
+	return SoundSystem::Get().emitterGain[id];
+}
+
+float SoundEmitter::GetPan() const
+{
+	assert(id != SoundSystem::NoEmitter);
+	return SoundSystem::Get().emitterPan[id];
+}
+
+const unsigned int& SoundEmitter::GetID() const
+{
+	return id;
+}
+
+SoundEmitter::~SoundEmitter()
+{
+	if (id != SoundSystem::NoEmitter)
+	{
+		SoundSystem::Get().DestroyEmitter(id);
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "SoundSystem.h"
+#include "Vector.h"
+
+class SoundEmitter
+{
+private:
+	unsigned int id;
+	vec2 position;
+	float volume;
+public:
+	SoundEmitter(vec2 position = { 0.0f,0.0f }, float volume = 1.0f);
+	SoundEmitter(const SoundEmitter& emitter) = delete;
+	SoundEmitter operator =(const SoundEmitter& emitter) = delete;
+	SoundEmitter(SoundEmitter&& emitter) noexcept;
+	void Play(class Sound& sound);
+	void SetPosition(vec2 pos);
+	void Move(vec2 delta);
+	const vec2& GetPosition() const;
+	void SetVolume(float volume);
+	const float& GetVolume() const;
+	float GetGain() const;
+	float GetPan() const;
+	const unsigned int& GetID() const;
+	~SoundEmitter();
+};
@@ -1,50 +1,662 @@
 #include "SoundSystem.h"
 #include "Sound.h"
+#include "Camera2D.h"
+#include <emmintrin.h>
+#include <chrono>
+
+bool SoundSystem::isHeadlessRequested = false;
+
+static long long ClockNow()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 void STDMETHODCALLTYPE SoundSystem::Channel::VoiceCallback::OnBufferEnd(void* pBufferContext)
 {
-	Channel& channel = *(Channel*)pBufferContext;
-	channel.pSound->hasTerminated();
-	channel.pSound = nullptr;
-	SoundSystem::Get().DeactivateChannel(channel);
+	if (!pBufferContext)
+	{
+		return;
+	}
+	const Submission& submission = *(Submission*)pBufferContext;
+	Channel& channel = *submission.pChannel;
+	std::atomic<unsigned int>* pInFlight = submission.pInFlight;
+	const VoiceEvent event = { (unsigned int)channel.id,submission.generation };
+	if (channel.nPending.fetch_sub(1u) == 1u)
+	{
+		SoundSystem& soundSys = SoundSystem::Get();
+		if (!soundSys.voiceEvents.Push(event))
+		{
+			soundSys.hasDroppedEvents = true;
+		}
+		--*pInFlight;
+		soundSys.ReleaseChannel(channel);
+	}
+	else
+	{
+		--*pInFlight;
+	}
+}
+
+void SoundSystem::EngineCallback::OnProcessingPassStart()
+{
+	XAUDIO2_VOICE_STATE state;
+	soundSys.pClockVoice->GetState(&state);
+	const UINT64 passStart = state.SamplesPlayed;
+	const UINT64 previous = soundSys.clockSamples.load(std::memory_order_relaxed);
+	if (passStart > previous)
+	{
+		soundSys.quantumSamples.store((unsigned int)(passStart - previous), std::memory_order_relaxed);
+	}
+	const unsigned int sequence = soundSys.clockSequence.load(std::memory_order_relaxed);
+	soundSys.clockSequence.store(sequence + 1u, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	soundSys.clockSamples.store(passStart, std::memory_order_relaxed);
+	soundSys.clockTime.store(ClockNow(), std::memory_order_relaxed);
+	soundSys.clockSequence.store(sequence + 2u, std::memory_order_release);
+	soundSys.ProcessSchedule(passStart);
 }
 
-void SoundSystem::Channel::StartSound(Sound& sound, float freqMod, float volume)
+void SoundSystem::Channel::PrepareSound(Sound& sound, float freqMod, float volume, int priority, UINT32 play_begin, unsigned int emitter)
 {
-	assert(pVoice && !pSound);
-	if (!SoundFmtsAreEqual(curSndFmt, sound.format))
+	assert(!pSound && nPending > 0u);
+	assert(bucket == sound.bucket && "Channel voice does not match the sound's format");
+	samplesAtStart = GetSamplesPlayed();
+	this->freqMod = freqMod;
+	this->volume = volume;
+	this->priority = priority;
+	this->emitter = emitter;
+	const SoundSystem& soundSys = SoundSystem::Get();
+	gain = emitter != NoEmitter ? soundSys.emitterGain[emitter] : 1.0f;
+	const float newPan = emitter != NoEmitter ? soundSys.emitterPan[emitter] : 0.0f;
+	if (newPan != pan)
 	{
-		pVoice->DestroyVoice();
-		pVoice = nullptr;
-		SoundSystem::Get().pEngine->CreateSourceVoice(&pVoice, &sound.format, 0u, 2.0f, &GetVCB());
-		curSndFmt = sound.format;
+		pan = newPan;
+		SetOutputPan(XAUDIO2_COMMIT_NOW);
 	}
+	curSubmission ^= 1u;
+	++generation;
+	submissions[curSubmission].pInFlight = sound.pBuffersInFlight.get();
+	submissions[curSubmission].generation = generation;
+	++*sound.pBuffersInFlight;
 	sound.hasStarted(*this);
 	pSound = &sound;
-	buffer.pAudioData = sound.pSoundData.get();
-	buffer.AudioBytes = sound.nSoundBytes;
-	SNDCHECK(pVoice->SubmitSourceBuffer(&buffer, nullptr));
-	SNDCHECK(pVoice->SetFrequencyRatio(freqMod));
-	SNDCHECK(pVoice->SetVolume(volume));
-	SNDCHECK(pVoice->Start());
+	buffer.pContext = &submissions[curSubmission];
+	buffer.pAudioData = sound.GetData();
+	buffer.AudioBytes = sound.GetDataSize();
+	buffer.PlayBegin = play_begin;
+	if (pVoice)
+	{
+		SNDCHECK(pVoice->SetFrequencyRatio(freqMod));
+		SNDCHECK(pVoice->SetVolume(volume * gain));
+	}
+}
+
+void SoundSystem::Channel::StartSound(Sound& sound, float freqMod, float volume, int priority, UINT32 play_begin, unsigned int emitter)
+{
+	PrepareSound(sound, freqMod, volume, priority, play_begin, emitter);
+	SNDCHECK(SubmitBuffer(buffer));
+	SNDCHECK(Play());
+}
+
+void SoundSystem::Channel::StartScheduled(UINT64 pass_start, UINT64 sample_time)
+{
+	const SoundSystem& soundSys = SoundSystem::Get();
+	const double ratio = double(curSndFmt.Format.nSamplesPerSec) * double(freqMod) / double(soundSys.sampleRate);
+	samplesAtStart = GetSamplesPlayed();
+	if (sample_time > pass_start)
+	{
+		const UINT32 nLead = std::min(UINT32(double(sample_time - pass_start) * ratio + 0.5), nSilenceFrames);
+		if (nLead > 0u)
+		{
+			XAUDIO2_BUFFER silence;
+			ZeroMemory(&silence, sizeof(silence));
+			silence.pAudioData = soundSys.pSilence.get();
+			silence.AudioBytes = nLead * curSndFmt.Format.nBlockAlign;
+			SubmitBuffer(silence);
+			samplesAtStart += nLead;
+		}
+	}
+	else
+	{
+		const UINT64 nLate = UINT64(double(pass_start - sample_time) * ratio);
+		const UINT32 nFrames = buffer.AudioBytes / curSndFmt.Format.nBlockAlign;
+		buffer.PlayBegin = UINT32(std::min<UINT64>(nLate, nFrames - 1u));
+	}
+	SubmitBuffer(buffer);
+	Play();
+	scheduleState.store((scheduleState.load(std::memory_order_relaxed) & ~3u) | Started, std::memory_order_release);
+}
+
+bool SoundSystem::Channel::CancelSchedule()
+{
+	unsigned int expected = (generation << 2) | Pending;
+	if (!scheduleState.compare_exchange_strong(expected, (generation << 2) | Idle, std::memory_order_acq_rel))
+	{
+		return false;
+	}
+	std::atomic<unsigned int>* pInFlight = submissions[curSubmission].pInFlight;
+	DetachSound();
+	--*pInFlight;
+	nPending = 0u;
+	SoundSystem::Get().ReleaseChannel(*this);
+	return true;
+}
+
+bool SoundSystem::Channel::IsScheduled() const
+{
+	const unsigned int state = scheduleState.load(std::memory_order_acquire) & 3u;
+	return state == Pending || state == Starting;
+}
+
+double SoundSystem::Channel::GetPlaybackPosition() const
+{
+	if (IsScheduled())
+	{
+		return 0.0;
+	}
+	if (!pVoice)
+	{
+		return std::max(double((long long)(GetSamplesPlayed() - samplesAtStart)) + double(buffer.PlayBegin), 0.0);
+	}
+	const SoundSystem& soundSys = SoundSystem::Get();
+	UINT64 samples;
+	long long time;
+	XAUDIO2_VOICE_STATE state;
+	unsigned int sequence;
+	do
+	{
+		sequence = soundSys.ReadClock(samples, time);
+		pVoice->GetState(&state);
+	} while (sequence != soundSys.clockSequence.load(std::memory_order_acquire));
+	const double ratio = double(curSndFmt.Format.nSamplesPerSec) * double(freqMod) / double(soundSys.sampleRate);
+	const double played = double((long long)(state.SamplesPlayed - samplesAtStart)) + double(buffer.PlayBegin) +
+		(soundSys.InterpolateClock(samples, time) - double(samples)) * ratio;
+	return std::max(played, 0.0);
+}
+
+Sound* SoundSystem::Channel::DetachSound()
+{
+	Sound* pDetached = pSound;
+	if (pDetached)
+	{
+		pDetached->hasTerminated(*this);
+		pSound = nullptr;
+	}
+	return pDetached;
+}
+
+void SoundSystem::Channel::SetSpatial(float gain, float pan, UINT32 operation_set)
+{
+	if (gain != this->gain)
+	{
+		this->gain = gain;
+		if (pVoice)
+		{
+			SNDCHECK(pVoice->SetVolume(volume * gain, operation_set));
+		}
+	}
+	if (pan != this->pan)
+	{
+		this->pan = pan;
+		SetOutputPan(operation_set);
+	}
+}
+
+void SoundSystem::Channel::SetOutputPan(UINT32 operation_set)
+{
+	const unsigned int nInputChannels = curSndFmt.Format.nChannels;
+	if (!pVoice || nOutputChannels < 2u || nOutputChannels > 8u || nInputChannels > 2u)
+	{
+		return;
+	}
+	float matrix[2u * 8u] = {};
+	matrix[0] = std::min(1.0f, 1.0f - pan);
+	matrix[nInputChannels + nInputChannels - 1u] = std::min(1.0f, 1.0f + pan);
+	SNDCHECK(pVoice->SetOutputMatrix(nullptr, nInputChannels, nOutputChannels, matrix, operation_set));
+}
+
+UINT64 SoundSystem::Channel::GetSamplesPlayed() const
+{
+	if (!pVoice)
+	{
+		return UINT64(simPlayed);
+	}
+	XAUDIO2_VOICE_STATE state;
+	pVoice->GetState(&state);
+	return state.SamplesPlayed;
+}
+
+HRESULT SoundSystem::Channel::SubmitBuffer(const XAUDIO2_BUFFER& buffer)
+{
+	if (pVoice)
+	{
+		return pVoice->SubmitSourceBuffer(&buffer, nullptr);
+	}
+	const UINT32 nFrames = buffer.AudioBytes / curSndFmt.Format.nBlockAlign;
+	simQueued += double(buffer.PlayLength ? buffer.PlayLength : nFrames - std::min(buffer.PlayBegin, nFrames));
+	if (buffer.pContext)
+	{
+		pSimContext = buffer.pContext;
+	}
+	return S_OK;
+}
+
+HRESULT SoundSystem::Channel::Play()
+{
+	if (pVoice)
+	{
+		return pVoice->Start();
+	}
+	isSimRunning = true;
+	return S_OK;
+}
+
+HRESULT SoundSystem::Channel::Halt()
+{
+	if (pVoice)
+	{
+		return pVoice->Stop();
+	}
+	isSimRunning = false;
+	return S_OK;
+}
+
+HRESULT SoundSystem::Channel::Flush()
+{
+	if (pVoice)
+	{
+		return pVoice->FlushSourceBuffers();
+	}
+	CompleteSimulated();
+	return S_OK;
+}
+
+void SoundSystem::Channel::CompleteSimulated()
+{
+	void* pContext = pSimContext;
+	pSimContext = nullptr;
+	simQueued = 0.0;
+	if (pContext)
+	{
+		GetVCB().OnBufferEnd(pContext);
+	}
+}
+
+void SoundSystem::Channel::Simulate(float dt)
+{
+	if (!isSimRunning || simQueued <= 0.0)
+	{
+		return;
+	}
+	const double nSamples = std::min(double(dt) * double(curSndFmt.Format.nSamplesPerSec) * double(freqMod), simQueued);
+	simPlayed += nSamples;
+	simQueued -= nSamples;
+	if (simQueued <= 0.0)
+	{
+		CompleteSimulated();
+	}
 }
 
 SoundSystem::SoundSystem()
+	:
+	isHeadless(isHeadlessRequested),
+	engineCallback(*this)
 {
+	virtualVoices.reserve(nMaxVirtualVoices);
+	scheduled.reserve(nMaxChannels + scheduleQueue.GetCapacity());
+	pSilence = std::make_unique<BYTE[]>(nSilenceFrames * 32u);
+	if (isHeadless)
+	{
+		return;
+	}
 	SNDCHECK(CoInitialize(nullptr));
 	SNDCHECK(XAudio2Create(&pEngine));
 	SNDCHECK(pEngine->CreateMasteringVoice(&pMasterVoice));
-	for (int i = 0; i < nChannels; ++i)
+	XAUDIO2_VOICE_DETAILS details;
+	pMasterVoice->GetVoiceDetails(&details);
+	nMasterChannels = details.InputChannels;
+	sampleRate = details.InputSampleRate;
+	WAVEFORMATEX clockFormat;
+	ZeroMemory(&clockFormat, sizeof(clockFormat));
+	clockFormat.wFormatTag = WAVE_FORMAT_PCM;
+	clockFormat.nChannels = 1;
+	clockFormat.nSamplesPerSec = sampleRate;
+	clockFormat.wBitsPerSample = 16;
+	clockFormat.nBlockAlign = 2;
+	clockFormat.nAvgBytesPerSec = sampleRate * 2u;
+	SNDCHECK(pEngine->CreateSourceVoice(&pClockVoice, &clockFormat));
+	XAUDIO2_BUFFER clockBuffer;
+	ZeroMemory(&clockBuffer, sizeof(clockBuffer));
+	clockBuffer.pAudioData = pSilence.get();
+	clockBuffer.AudioBytes = nSilenceFrames * clockFormat.nBlockAlign;
+	clockBuffer.LoopCount = XAUDIO2_LOOP_INFINITE;
+	SNDCHECK(pClockVoice->SubmitSourceBuffer(&clockBuffer));
+	SNDCHECK(pClockVoice->SetVolume(0.0f));
+	SNDCHECK(pClockVoice->Start());
+	SNDCHECK(pEngine->RegisterForCallbacks(&engineCallback));
+	SetMasterVolume(1.0f);
+}
+
+void SoundSystem::ReleaseChannel(Channel& channel)
+{
+	PushFreeChannel(channel);
+	--nActiveChannels;
+}
+
+void SoundSystem::PushFreeChannel(Channel& channel)
+{
+	FormatBucket& formatBucket = buckets[channel.GetBucket()];
+	const unsigned int index = (unsigned int)channel.GetID();
+	unsigned long long head = formatBucket.freeHead.load(std::memory_order_relaxed);
+	unsigned long long newHead;
+	do
 	{
-		channels[i] = std::move(std::make_unique<Channel>(*this, i));
-		channelIsActive[i] = false;
+		freeNext[index].store((unsigned int)(head & 0xFFFFFFFFull), std::memory_order_relaxed);
+		newHead = (((head >> 32) + 1ull) << 32) | index;
+	} while (!formatBucket.freeHead.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+	++formatBucket.nFreeChannels;
+}
+
+unsigned int SoundSystem::RegisterFormat(const WAVEFORMATEXTENSIBLE& format)
+{
+	for (unsigned int i = 0u; i < nBuckets; ++i)
+	{
+		if (SoundFmtsAreEqual(buckets[i].format, format))
+		{
+			return i;
+		}
 	}
-	SetMasterVolume(1.0f);
+	if (nBuckets == nMaxFormats)
+	{
+		throw SNDEXCPT("Too many distinct sound formats, consider setting a canonical format!");
+	}
+	FormatBucket& formatBucket = buckets[nBuckets];
+	formatBucket.format = format;
+	for (unsigned int i = 0u; i < nMaxActiveChannels; ++i)
+	{
+		channels[nChannels + i] = std::make_unique<Channel>(*this, int(nChannels + i), nBuckets, format);
+	}
+	for (unsigned int i = nMaxActiveChannels; i > 0u; --i)
+	{
+		PushFreeChannel(*channels[nChannels + i - 1u]);
+	}
+	nChannels += nMaxActiveChannels;
+	return nBuckets++;
 }
 
-void SoundSystem::DeactivateChannel(Channel& channel)
+SoundSystem::Channel* SoundSystem::AcquireChannel(unsigned int bucket, bool over_budget)
 {
-	channelIsActive[channel.GetID()] = false;
+	if (!over_budget && nActiveChannels >= nMaxActiveChannels)
+	{
+		return nullptr;
+	}
+	FormatBucket& formatBucket = buckets[bucket];
+	unsigned long long head = formatBucket.freeHead.load(std::memory_order_acquire);
+	while (true)
+	{
+		const unsigned int index = (unsigned int)(head & 0xFFFFFFFFull);
+		if (index >= nMaxChannels)
+		{
+			return nullptr;
+		}
+		const unsigned long long newHead = (((head >> 32) + 1ull) << 32) | freeNext[index].load(std::memory_order_relaxed);
+		if (formatBucket.freeHead.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire))
+		{
+			--formatBucket.nFreeChannels;
+			++nActiveChannels;
+			Channel& channel = *channels[index];
+			TerminateChannel(channel);
+			channel.nPending = 1u;
+			return &channel;
+		}
+	}
+}
+
+void SoundSystem::ProcessVoiceEvents()
+{
+	voiceEvents.Drain([this](const VoiceEvent& event)
+		{
+			Channel& channel = *channels[event.channel];
+			if (channel.generation == event.generation)
+			{
+				TerminateChannel(channel);
+			}
+		});
+	if (hasDroppedEvents.exchange(false))
+	{
+		for (unsigned int i = 0u; i < nChannels; ++i)
+		{
+			if (channels[i]->nPending == 0u)
+			{
+				TerminateChannel(*channels[i]);
+			}
+		}
+	}
+}
+
+void SoundSystem::TerminateChannel(Channel& channel)
+{
+	if (channel.pSound)
+	{
+		channel.pSound->hasTerminated(channel);
+		channel.pSound = nullptr;
+	}
+}
+
+bool SoundSystem::HasFreeChannel(unsigned int bucket) const
+{
+	return buckets[bucket].nFreeChannels > 0u && nActiveChannels < nMaxActiveChannels;
+}
+
+SoundSystem::Channel* SoundSystem::StealChannel(unsigned int bucket, int priority)
+{
+	Channel* pVictim = nullptr;
+	for (unsigned int i = 0u; i < nChannels; ++i)
+	{
+		Channel& channel = *channels[i];
+		if (!channel.pSound || channel.priority > priority || channel.IsScheduled())
+		{
+			continue;
+		}
+		if (!pVictim || channel.priority < pVictim->priority ||
+			(channel.priority == pVictim->priority && channel.volume * channel.gain < pVictim->volume * pVictim->gain))
+		{
+			pVictim = &channel;
+		}
+	}
+	if (!pVictim)
+	{
+		return nullptr;
+	}
+	if (pVictim->nPending.fetch_add(1u) != 1u)
+	{
+		--pVictim->nPending;
+		return nullptr;
+	}
+	const UINT32 position = pVictim->GetSamplePosition();
+	SNDCHECK(pVictim->Halt());
+	SNDCHECK(pVictim->Flush());
+	Sound* pStolen = pVictim->DetachSound();
+	if (pStolen)
+	{
+		Virtualize(*pStolen, double(position), pVictim->freqMod, pVictim->volume, pVictim->priority, pVictim->emitter);
+	}
+	if (pVictim->GetBucket() == bucket)
+	{
+		return pVictim;
+	}
+	if (pVictim->nPending.fetch_sub(1u) == 1u)
+	{
+		ReleaseChannel(*pVictim);
+	}
+	return AcquireChannel(bucket, true);
+}
+
+bool SoundSystem::Virtualize(Sound& sound, double position, float freqMod, float volume, int priority, unsigned int emitter)
+{
+	if (position >= double(sound.GetSampleCount()))
+	{
+		return false;
+	}
+	if (virtualVoices.size() >= nMaxVirtualVoices)
+	{
+		if (virtualVoices.back().priority >= priority)
+		{
+			return false;
+		}
+		--virtualVoices.back().pSound->nVirtualInstances;
+		virtualVoices.pop_back();
+	}
+	const auto position_it = std::upper_bound(virtualVoices.begin(), virtualVoices.end(), priority,
+		[](int priority, const VirtualVoice& voice)
+		{
+			return priority > voice.priority;
+		});
+	virtualVoices.insert(position_it, { &sound,position,freqMod,volume,priority,emitter });
+	++sound.nVirtualInstances;
+	return true;
+}
+
+void SoundSystem::RetargetSound(Sound& from, Sound& to) noexcept
+{
+	for (unsigned int i = 0u; i < nChannels; ++i)
+	{
+		if (channels[i]->pSound == &from)
+		{
+			channels[i]->pSound = &to;
+		}
+	}
+	for (VirtualVoice& voice : virtualVoices)
+	{
+		if (voice.pSound == &from)
+		{
+			voice.pSound = &to;
+		}
+	}
+}
+
+void SoundSystem::StopVirtual(Sound& sound, bool stop_all)
+{
+	for (size_t i = 0u; i < virtualVoices.size();)
+	{
+		if (virtualVoices[i].pSound == &sound)
+		{
+			--sound.nVirtualInstances;
+			virtualVoices.erase(virtualVoices.begin() + i);
+			if (!stop_all)
+			{
+				return;
+			}
+		}
+		else
+		{
+			++i;
+		}
+	}
+}
+
+unsigned int SoundSystem::CreateEmitter(float x, float y, float volume)
+{
+	if (freeEmitters.empty())
+	{
+		const unsigned int first = (unsigned int)emitterX.size();
+		for (std::vector<float>* pArray : { &emitterX,&emitterY,&emitterVolume,&emitterGain,&emitterPan })
+		{
+			pArray->resize(first + 4u, 0.0f);
+		}
+		for (unsigned int i = 4u; i > 0u; --i)
+		{
+			freeEmitters.push_back(first + i - 1u);
+		}
+	}
+	const unsigned int emitter = freeEmitters.back();
+	freeEmitters.pop_back();
+	emitterX[emitter] = x;
+	emitterY[emitter] = y;
+	emitterVolume[emitter] = volume;
+	SpatializeEmitters(emitter & ~3u, 4u);
+	++nEmitters;
+	return emitter;
+}
+
+void SoundSystem::DestroyEmitter(unsigned int emitter)
+{
+	for (unsigned int i = 0u; i < nChannels; ++i)
+	{
+		if (channels[i]->emitter == emitter)
+		{
+			channels[i]->emitter = NoEmitter;
+		}
+	}
+	for (VirtualVoice& voice : virtualVoices)
+	{
+		if (voice.emitter == emitter)
+		{
+			voice.emitter = NoEmitter;
+		}
+	}
+	emitterVolume[emitter] = 0.0f;
+	freeEmitters.push_back(emitter);
+	--nEmitters;
+}
+
+void SoundSystem::SpatializeEmitters(size_t first, size_t count)
+{
+	assert(first % 4u == 0u && count % 4u == 0u);
+	float listenerX = 0.0f;
+	float listenerY = 0.0f;
+	float rotation = 0.0f;
+	if (pListener)
+	{
+		listenerX = pListener->GetPosition().x;
+		listenerY = pListener->GetPosition().y;
+		rotation = pListener->GetRotation();
+	}
+	const __m128 lx = _mm_set1_ps(listenerX);
+	const __m128 ly = _mm_set1_ps(listenerY);
+	const __m128 cosR = _mm_set1_ps(std::cos(rotation));
+	const __m128 sinR = _mm_set1_ps(std::sin(rotation));
+	const __m128 maxD = _mm_set1_ps(maxDistance);
+	const __m128 invRange = _mm_set1_ps(1.0f / std::max(maxDistance - minDistance, 1e-6f));
+	const __m128 invPanWidth = _mm_set1_ps(1.0f / std::max(panWidth, 1e-6f));
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 minusOne = _mm_set1_ps(-1.0f);
+	for (size_t i = first; i < first + count; i += 4u)
+	{
+		const __m128 dx = _mm_sub_ps(_mm_loadu_ps(&emitterX[i]), lx);
+		const __m128 dy = _mm_sub_ps(_mm_loadu_ps(&emitterY[i]), ly);
+		const __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+		const __m128 falloff = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(maxD, distance), invRange), zero), one);
+		_mm_storeu_ps(&emitterGain[i], _mm_mul_ps(falloff, _mm_loadu_ps(&emitterVolume[i])));
+		const __m128 side = _mm_add_ps(_mm_mul_ps(dx, cosR), _mm_mul_ps(dy, sinR));
+		_mm_storeu_ps(&emitterPan[i], _mm_min_ps(_mm_max_ps(_mm_mul_ps(side, invPanWidth), minusOne), one));
+	}
+}
+
+void SoundSystem::ApplyEmitters()
+{
+	bool hasChanges = false;
+	for (unsigned int i = 0u; i < nChannels; ++i)
+	{
+		Channel& channel = *channels[i];
+		if (!channel.pSound || channel.emitter == NoEmitter)
+		{
+			continue;
+		}
+		const float gain = emitterGain[channel.emitter];
+		const float pan = emitterPan[channel.emitter];
+		if (std::abs(gain - channel.gain) > gainThreshold || std::abs(pan - channel.pan) > panThreshold ||
+			((gain == 0.0f) != (channel.gain == 0.0f)))
+		{
+			channel.SetSpatial(gain, pan, SpatialOperationSet);
+			hasChanges = true;
+		}
+	}
+	if (hasChanges && pEngine)
+	{
+		SNDCHECK(pEngine->CommitChanges(SpatialOperationSet));
+	}
 }
 
 SoundSystem& SoundSystem::Get()
@@ -53,37 +665,283 @@ SoundSystem& SoundSystem::Get()
 	return instance;
 }
 
-void SoundSystem::StartSound(Sound& sound, float freqMod, float volume)
+void SoundSystem::SetHeadless(bool headless)
+{
+	isHeadlessRequested = headless;
+}
+
+SoundSystem::Channel* SoundSystem::FindChannel(unsigned int bucket, int priority)
+{
+	Channel* pChannel = AcquireChannel(bucket);
+	if (!pChannel)
+	{
+		pChannel = StealChannel(bucket, priority);
+	}
+	if (!pChannel)
+	{
+		pChannel = AcquireChannel(bucket);
+	}
+	return pChannel;
+}
+
+void SoundSystem::StartSound(Sound& sound, float freqMod, float volume, int priority, unsigned int emitter)
+{
+	if (Channel* pChannel = FindChannel(sound.bucket, priority))
+	{
+		pChannel->StartSound(sound, freqMod, volume, priority, 0u, emitter);
+	}
+	else
+	{
+		Virtualize(sound, 0.0, freqMod, volume, priority, emitter);
+	}
+}
+
+void SoundSystem::ScheduleSound(Sound& sound, UINT64 sample_time, float freqMod, float volume, int priority, unsigned int emitter)
+{
+	Channel* pChannel = FindChannel(sound.bucket, priority);
+	if (!pChannel)
+	{
+		const double ratio = double(sound.GetFormat().Format.nSamplesPerSec) * double(freqMod) / double(sampleRate);
+		Virtualize(sound, (double(GetSampleTime()) - double(sample_time)) * ratio, freqMod, volume, priority, emitter);
+		return;
+	}
+	pChannel->PrepareSound(sound, freqMod, volume, priority, 0u, emitter);
+	const unsigned int generation = pChannel->generation;
+	pChannel->scheduleState.store((generation << 2) | Channel::Pending, std::memory_order_release);
+	if (!scheduleQueue.Push({ (unsigned int)pChannel->id,generation,sample_time }))
+	{
+		pChannel->scheduleState.store((generation << 2) | Channel::Idle, std::memory_order_release);
+		SNDCHECK(pChannel->SubmitBuffer(pChannel->buffer));
+		SNDCHECK(pChannel->Play());
+	}
+}
+
+void SoundSystem::ProcessSchedule(UINT64 pass_start)
 {
-	for (int i = 0; i < nChannels; ++i)
+	scheduleQueue.Drain([this](const ScheduledStart& start)
+		{
+			scheduled.push_back(start);
+		});
+	const UINT64 passEnd = pass_start + quantumSamples.load(std::memory_order_relaxed);
+	for (size_t i = 0u; i < scheduled.size();)
+	{
+		const ScheduledStart start = scheduled[i];
+		Channel& channel = *channels[start.channel];
+		unsigned int expected = (start.generation << 2) | Channel::Pending;
+		if (channel.scheduleState.load(std::memory_order_acquire) != expected)
+		{
+			scheduled[i] = scheduled.back();
+			scheduled.pop_back();
+			continue;
+		}
+		if (start.sampleTime >= passEnd)
+		{
+			++i;
+			continue;
+		}
+		scheduled[i] = scheduled.back();
+		scheduled.pop_back();
+		if (channel.scheduleState.compare_exchange_strong(expected, (start.generation << 2) | Channel::Starting, std::memory_order_acq_rel))
+		{
+			channel.StartScheduled(pass_start, start.sampleTime);
+		}
+	}
+}
+
+unsigned int SoundSystem::ReadClock(UINT64& samples, long long& time) const
+{
+	unsigned int sequence;
+	do
+	{
+		sequence = clockSequence.load(std::memory_order_acquire);
+		samples = clockSamples.load(std::memory_order_relaxed);
+		time = clockTime.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+	} while ((sequence & 1u) || sequence != clockSequence.load(std::memory_order_relaxed));
+	return sequence;
+}
+
+double SoundSystem::InterpolateClock(UINT64 samples, long long time) const
+{
+	const double elapsed = double(std::max(ClockNow() - time, 0ll)) * 1e-9 * double(sampleRate);
+	return double(samples) + std::min(elapsed, double(quantumSamples.load(std::memory_order_relaxed)));
+}
+
+UINT64 SoundSystem::GetSampleTime() const
+{
+	if (isHeadless)
+	{
+		return clockSamples.load(std::memory_order_relaxed);
+	}
+	UINT64 samples;
+	long long time;
+	ReadClock(samples, time);
+	lastSampleTime = std::max(lastSampleTime, UINT64(InterpolateClock(samples, time)));
+	return lastSampleTime;
+}
+
+double SoundSystem::GetAudioTime() const
+{
+	return double(GetSampleTime()) / double(sampleRate);
+}
+
+const unsigned int& SoundSystem::GetSampleRate() const
+{
+	return sampleRate;
+}
+
+const bool& SoundSystem::IsHeadless() const
+{
+	return isHeadless;
+}
+
+void SoundSystem::SimulatePass(float dt)
+{
+	const UINT64 passStart = clockSamples.load(std::memory_order_relaxed);
+	simulatedSamples += double(dt) * double(sampleRate);
+	const UINT64 passEnd = std::max(UINT64(simulatedSamples), passStart);
+	quantumSamples.store((unsigned int)(passEnd - passStart), std::memory_order_relaxed);
+	ProcessSchedule(passStart);
+	for (unsigned int i = 0u; i < nChannels; ++i)
 	{
-		if (!channelIsActive[i])
+		channels[i]->Simulate(dt);
+	}
+	clockSamples.store(passEnd, std::memory_order_relaxed);
+}
+
+void SoundSystem::Update(float dt)
+{
+	if (isHeadless)
+	{
+		SimulatePass(dt);
+	}
+	ProcessVoiceEvents();
+	SpatializeEmitters(0u, emitterX.size());
+	size_t nKept = 0u;
+	for (size_t i = 0u; i < virtualVoices.size(); ++i)
+	{
+		VirtualVoice voice = virtualVoices[i];
+		voice.position += double(dt) * double(voice.pSound->GetFormat().Format.nSamplesPerSec) * double(voice.freqMod);
+		if (voice.position >= double(voice.pSound->GetSampleCount()))
+		{
+			--voice.pSound->nVirtualInstances;
+			continue;
+		}
+		Channel* pChannel = voice.position >= 0.0 && HasFreeChannel(voice.pSound->bucket) ? AcquireChannel(voice.pSound->bucket) : nullptr;
+		if (pChannel)
 		{
-			channels[i]->StartSound(sound, freqMod, volume);
-			channelIsActive[i] = true;
-			break;
+			--voice.pSound->nVirtualInstances;
+			pChannel->StartSound(*voice.pSound, voice.freqMod, voice.volume, voice.priority, UINT32(voice.position), voice.emitter);
+			continue;
 		}
+		virtualVoices[nKept++] = voice;
 	}
+	virtualVoices.resize(nKept);
+	ApplyEmitters();
+}
+
+void SoundSystem::SetListener(const Camera2D* pCamera)
+{
+	pListener = pCamera;
+}
+
+void SoundSystem::SetAttenuation(float min_distance, float max_distance)
+{
+	assert(min_distance >= 0.0f && max_distance > min_distance);
+	minDistance = min_distance;
+	maxDistance = max_distance;
+}
+
+void SoundSystem::SetPanWidth(float width)
+{
+	assert(width > 0.0f);
+	panWidth = width;
+}
+
+void SoundSystem::SetSpatialThresholds(float gain_threshold, float pan_threshold)
+{
+	gainThreshold = gain_threshold;
+	panThreshold = pan_threshold;
+}
+
+unsigned int SoundSystem::GetEmitterCount() const
+{
+	return nEmitters;
+}
+
+void SoundSystem::SetCanonicalFormat(unsigned int sample_rate, unsigned int n_channels)
+{
+	assert(n_channels == 1u || n_channels == 2u);
+	WAVEFORMATEXTENSIBLE format;
+	ZeroMemory(&format, sizeof(format));
+	format.Format.wFormatTag = WAVE_FORMAT_PCM;
+	format.Format.nChannels = WORD(n_channels);
+	format.Format.nSamplesPerSec = sample_rate;
+	format.Format.wBitsPerSample = 16;
+	format.Format.nBlockAlign = WORD(n_channels * 2u);
+	format.Format.nAvgBytesPerSec = sample_rate * format.Format.nBlockAlign;
+	canonicalFormat = format;
+}
+
+void SoundSystem::ClearCanonicalFormat()
+{
+	canonicalFormat.reset();
+}
+
+const std::optional<WAVEFORMATEXTENSIBLE>& SoundSystem::GetCanonicalFormat() const
+{
+	return canonicalFormat;
+}
+
+unsigned int SoundSystem::GetFormatCount() const
+{
+	return nBuckets;
+}
+
+unsigned int SoundSystem::GetChannelCount() const
+{
+	return nChannels;
+}
+
+unsigned int SoundSystem::GetFreeChannelCount() const
+{
+	unsigned int nFree = 0u;
+	for (unsigned int i = 0u; i < nBuckets; ++i)
+	{
+		nFree += buckets[i].nFreeChannels;
+	}
+	return std::min(nFree, nMaxActiveChannels - std::min(nActiveChannels.load(), nMaxActiveChannels));
+}
+
+unsigned int SoundSystem::GetVirtualVoiceCount() const
+{
+	return (unsigned int)virtualVoices.size();
 }
 
 void SoundSystem::SetMasterVolume(float volume)
 {
-	SNDCHECK(pMasterVoice->SetVolume(volume));
+	masterVolume = volume;
+	if (pMasterVoice)
+	{
+		SNDCHECK(pMasterVoice->SetVolume(volume));
+	}
 }
 
 float SoundSystem::GetMasterVolume() const
 {
-	float volume;
-	pMasterVoice->GetVolume(&volume);
-	return volume;
+	return masterVolume;
 }
 
 SoundSystem::~SoundSystem()
 {
+	if (isHeadless)
+	{
+		return;
+	}
+	pEngine->UnregisterForCallbacks(&engineCallback);
+	pClockVoice->DestroyVoice();
+	pClockVoice = nullptr;
 	pMasterVoice->DestroyVoice();
 	pMasterVoice = nullptr;
 	CoUninitialize();
 }
-
-
-
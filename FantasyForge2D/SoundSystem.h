@@ -7,13 +7,25 @@
 #include <bitset>
 #include <assert.h>
 #include <optional>
+#include <atomic>
+#include <thread>
+#include "SPSCQueue.h"
 
 #pragma comment(lib, "xaudio2.lib")
 
 class SoundSystem
 {
+	friend class Sound;
+	friend class StreamingSound;
+	friend class SoundEmitter;
 public:
-	static constexpr unsigned int nChannels = 64u;
+	static constexpr unsigned int nMaxActiveChannels = 64u;
+	static constexpr unsigned int nMaxFormats = 8u;
+	static constexpr unsigned int nMaxChannels = nMaxActiveChannels * nMaxFormats;
+	static constexpr unsigned int nMaxVirtualVoices = 256u;
+	static constexpr unsigned int NoEmitter = 0xFFFFFFFFu;
+	static constexpr UINT32 SpatialOperationSet = 1u;
+	static constexpr UINT32 nSilenceFrames = 4096u;
 public:
 	class Exception : public BaseException
 	{
@@ -91,67 +103,142 @@ public:
 			void STDMETHODCALLTYPE OnLoopEnd(void* pBufferContext) override {}
 			void STDMETHODCALLTYPE OnVoiceError(void* pBufferContext, HRESULT error) override {}
 		};
+		struct Submission
+		{
+			Channel* pChannel;
+			std::atomic<unsigned int>* pInFlight;
+			unsigned int generation;
+		};
+	public:
+		static constexpr unsigned int Idle = 0u;
+		static constexpr unsigned int Pending = 1u;
+		static constexpr unsigned int Starting = 2u;
+		static constexpr unsigned int Started = 3u;
 	private:
-		WAVEFORMATEX curSndFmt;
+		WAVEFORMATEXTENSIBLE curSndFmt;
 		XAUDIO2_BUFFER buffer;
-		IXAudio2SourceVoice* pVoice;
-		class Sound* pSound;
+		IXAudio2SourceVoice* pVoice = nullptr;
+		class Sound* pSound = nullptr;
+		std::atomic<unsigned int> nPending = 0u;
+		Submission submissions[2];
+		unsigned int curSubmission = 0u;
+		unsigned int generation = 0u;
+		UINT64 samplesAtStart = 0u;
+		std::atomic<unsigned int> scheduleState = Idle;
+		float freqMod = 1.0f;
+		float volume = 1.0f;
+		int priority = 0;
+		unsigned int emitter = NoEmitter;
+		float gain = 1.0f;
+		float pan = 0.0f;
+		const unsigned int nOutputChannels;
+		const unsigned int bucket;
 		int id;
+		double simPlayed = 0.0;
+		double simQueued = 0.0;
+		void* pSimContext = nullptr;
+		bool isSimRunning = false;
 	private:
-		void StartSound(class Sound& sound, float freqMod, float volume);
+		void PrepareSound(class Sound& sound, float freqMod, float volume, int priority, UINT32 play_begin, unsigned int emitter);
+		void StartSound(class Sound& sound, float freqMod, float volume, int priority, UINT32 play_begin, unsigned int emitter);
+		void StartScheduled(UINT64 pass_start, UINT64 sample_time);
+		bool CancelSchedule();
+		bool IsScheduled() const;
+		class Sound* DetachSound();
+		void SetSpatial(float gain, float pan, UINT32 operation_set);
+		void SetOutputPan(UINT32 operation_set);
+		UINT64 GetSamplesPlayed() const;
+		HRESULT SubmitBuffer(const XAUDIO2_BUFFER& buffer);
+		HRESULT Play();
+		HRESULT Halt();
+		HRESULT Flush();
+		void CompleteSimulated();
+		void Simulate(float dt);
 	public:
 		Channel() = delete;
-		Channel(SoundSystem& soundSys, int id)
+		Channel(SoundSystem& soundSys, int id, unsigned int bucket, const WAVEFORMATEXTENSIBLE& format)
 			:
+			curSndFmt(format),
+			nOutputChannels(soundSys.nMasterChannels),
+			bucket(bucket),
 			id(id)
 		{
-			curSndFmt.wFormatTag = WAVE_FORMAT_PCM;
-			curSndFmt.nChannels = 2;
-			curSndFmt.nSamplesPerSec = 44100;
-			curSndFmt.nAvgBytesPerSec = 176400;
-			curSndFmt.nBlockAlign = 4;
-			curSndFmt.wBitsPerSample = 16;
-			curSndFmt.cbSize = 0;
-			static VoiceCallback vcb;
 			ZeroMemory(&buffer, sizeof(buffer));
-			buffer.pContext = this;
-			SNDCHECK(soundSys.pEngine->CreateSourceVoice(&pVoice, &curSndFmt, 0u, 2.0f, &GetVCB()));
+			submissions[0] = { this,nullptr,0u };
+			submissions[1] = { this,nullptr,0u };
+			if (!soundSys.isHeadless)
+			{
+				SNDCHECK(soundSys.pEngine->CreateSourceVoice(&pVoice, &curSndFmt.Format, 0u, 2.0f, &GetVCB()));
+				SetOutputPan(XAUDIO2_COMMIT_NOW);
+			}
 		}
 		Channel(const Channel& channel) = delete;
 		Channel operator =(const Channel& channel) = delete;
 		void StopSound()
 		{
-			assert(pVoice && pSound);
-			SNDCHECK(pVoice->Stop());
-			SNDCHECK(pVoice->FlushSourceBuffers());
-			while (pSound);
+			if (CancelSchedule())
+			{
+				return;
+			}
+			while ((scheduleState.load(std::memory_order_acquire) & 3u) == Starting)
+			{
+				std::this_thread::yield();
+			}
+			DetachSound();
+			SNDCHECK(Halt());
+			SNDCHECK(Flush());
 		}
 		void ResumeSound()
 		{
-			assert(pVoice && pSound);
-			SNDCHECK(pVoice->Start());
+			assert(pSound);
+			SNDCHECK(Play());
 		}
 		void PauseSound()
 		{
-			assert(pVoice && pSound);
-			SNDCHECK(pVoice->Stop());
+			assert(pSound);
+			SNDCHECK(Halt());
 		}
 		void SetVolume(float volume)
 		{
-			assert(pVoice && pSound);
-			SNDCHECK(pVoice->SetVolume(volume));
+			assert(pSound);
+			this->volume = volume;
+			if (pVoice)
+			{
+				SNDCHECK(pVoice->SetVolume(volume * gain));
+			}
 		}
+		UINT32 GetSamplePosition() const
+		{
+			const UINT64 samplesPlayed = GetSamplesPlayed();
+			if (samplesPlayed < samplesAtStart)
+			{
+				return buffer.PlayBegin;
+			}
+			return UINT32(samplesPlayed - samplesAtStart) + buffer.PlayBegin;
+		}
+		double GetPlaybackPosition() const;
 		const int& GetID() const
 		{
 			return id;
 		}
+		const int& GetPriority() const
+		{
+			return priority;
+		}
+		const unsigned int& GetBucket() const
+		{
+			return bucket;
+		}
+		const unsigned int& GetEmitter() const
+		{
+			return emitter;
+		}
 		class Sound* GetSoundPtr()
 		{
 			return pSound;
 		}
 		~Channel()
 		{
-			assert(!pSound);
 			if (pVoice)
 			{
 				pVoice->DestroyVoice();
@@ -164,30 +251,148 @@ public:
 			static VoiceCallback vcb;
 			return vcb;
 		}
-		static bool SoundFmtsAreEqual(WAVEFORMATEX left, WAVEFORMATEX right)
-		{
-			return (
-				left.wFormatTag			==		right.wFormatTag		&&
-				left.nChannels			==		right.nChannels			&&
-				left.nSamplesPerSec		==		right.nSamplesPerSec	&&
-				left.nAvgBytesPerSec	==		right.nAvgBytesPerSec	&&
-				left.nBlockAlign		==		right.nBlockAlign		&&
-				left.wBitsPerSample		==		right.wBitsPerSample	);
-		}
 	};
 private:
+	struct VoiceEvent
+	{
+		unsigned int channel;
+		unsigned int generation;
+	};
+	struct ScheduledStart
+	{
+		unsigned int channel;
+		unsigned int generation;
+		UINT64 sampleTime;
+	};
+	class EngineCallback : public IXAudio2EngineCallback
+	{
+	private:
+		SoundSystem& soundSys;
+	public:
+		EngineCallback(SoundSystem& soundSys)
+			:
+			soundSys(soundSys)
+		{}
+		void STDMETHODCALLTYPE OnProcessingPassStart() override;
+		void STDMETHODCALLTYPE OnProcessingPassEnd() override {}
+		void STDMETHODCALLTYPE OnCriticalError(HRESULT error) override {}
+	};
+	struct FormatBucket
+	{
+		WAVEFORMATEXTENSIBLE format;
+		std::atomic<unsigned long long> freeHead = (unsigned long long)nMaxChannels;
+		std::atomic<unsigned int> nFreeChannels = 0u;
+	};
+	struct VirtualVoice
+	{
+		class Sound* pSound;
+		double position;
+		float freqMod;
+		float volume;
+		int priority;
+		unsigned int emitter;
+	};
+private:
+	static bool isHeadlessRequested;
+	const bool isHeadless;
 	Microsoft::WRL::ComPtr<IXAudio2> pEngine;
-	IXAudio2MasteringVoice* pMasterVoice;
-	std::unique_ptr<Channel> channels[nChannels];
-	std::bitset<nChannels> channelIsActive;
+	IXAudio2MasteringVoice* pMasterVoice = nullptr;
+	std::unique_ptr<Channel> channels[nMaxChannels];
+	std::atomic<unsigned int> freeNext[nMaxChannels];
+	unsigned int nChannels = 0u;
+	std::atomic<unsigned int> nActiveChannels = 0u;
+	FormatBucket buckets[nMaxFormats];
+	unsigned int nBuckets = 0u;
+	std::optional<WAVEFORMATEXTENSIBLE> canonicalFormat;
+	SPSCQueue<VoiceEvent, 256u> voiceEvents;
+	std::atomic<bool> hasDroppedEvents = false;
+	std::vector<VirtualVoice> virtualVoices;
+	unsigned int nMasterChannels = 2u;
+	std::vector<float> emitterX;
+	std::vector<float> emitterY;
+	std::vector<float> emitterVolume;
+	std::vector<float> emitterGain;
+	std::vector<float> emitterPan;
+	std::vector<unsigned int> freeEmitters;
+	unsigned int nEmitters = 0u;
+	const class Camera2D* pListener = nullptr;
+	float minDistance = 64.0f;
+	float maxDistance = 1024.0f;
+	float panWidth = 512.0f;
+	float gainThreshold = 0.01f;
+	float panThreshold = 0.02f;
+	EngineCallback engineCallback;
+	IXAudio2SourceVoice* pClockVoice = nullptr;
+	std::unique_ptr<BYTE[]> pSilence;
+	unsigned int sampleRate = 48000u;
+	std::atomic<unsigned int> clockSequence = 0u;
+	std::atomic<UINT64> clockSamples = 0u;
+	std::atomic<long long> clockTime = 0;
+	std::atomic<unsigned int> quantumSamples = 480u;
+	mutable UINT64 lastSampleTime = 0u;
+	double simulatedSamples = 0.0;
+	float masterVolume = 1.0f;
+	SPSCQueue<ScheduledStart, 256u> scheduleQueue;
+	std::vector<ScheduledStart> scheduled;
 private:
 	SoundSystem();
-	void DeactivateChannel(Channel& channel);
+	void ReleaseChannel(Channel& channel);
+	void ProcessVoiceEvents();
+	void TerminateChannel(Channel& channel);
+	unsigned int RegisterFormat(const WAVEFORMATEXTENSIBLE& format);
+	void PushFreeChannel(Channel& channel);
+	Channel* AcquireChannel(unsigned int bucket, bool over_budget = false);
+	bool HasFreeChannel(unsigned int bucket) const;
+	Channel* StealChannel(unsigned int bucket, int priority);
+	Channel* FindChannel(unsigned int bucket, int priority);
+	bool Virtualize(class Sound& sound, double position, float freqMod, float volume, int priority, unsigned int emitter);
+	void StopVirtual(class Sound& sound, bool stop_all);
+	void RetargetSound(class Sound& from, class Sound& to) noexcept;
+	unsigned int CreateEmitter(float x, float y, float volume);
+	void DestroyEmitter(unsigned int emitter);
+	void SpatializeEmitters(size_t first, size_t count);
+	void ApplyEmitters();
+	void ProcessSchedule(UINT64 pass_start);
+	void SimulatePass(float dt);
+	unsigned int ReadClock(UINT64& samples, long long& time) const;
+	double InterpolateClock(UINT64 samples, long long time) const;
 public:
 	SoundSystem(const SoundSystem& soundSys) = delete;
 	SoundSystem operator =(const SoundSystem& soundSys) = delete;
 	static SoundSystem& Get();
-	void StartSound(class Sound& sound, float freqMod, float volume);
+	static void SetHeadless(bool headless);
+	static bool SoundFmtsAreEqual(const WAVEFORMATEXTENSIBLE& left, const WAVEFORMATEXTENSIBLE& right)
+	{
+		return (
+			left.Format.wFormatTag			==		right.Format.wFormatTag			&&
+			left.Format.nChannels			==		right.Format.nChannels			&&
+			left.Format.nSamplesPerSec		==		right.Format.nSamplesPerSec		&&
+			left.Format.nAvgBytesPerSec		==		right.Format.nAvgBytesPerSec	&&
+			left.Format.nBlockAlign			==		right.Format.nBlockAlign		&&
+			left.Format.wBitsPerSample		==		right.Format.wBitsPerSample		&&
+			(left.Format.wFormatTag != WAVE_FORMAT_EXTENSIBLE ||
+			(left.dwChannelMask == right.dwChannelMask &&
+			memcmp(&left.SubFormat, &right.SubFormat, sizeof(GUID)) == 0))	);
+	}
+	void StartSound(class Sound& sound, float freqMod, float volume, int priority = 0, unsigned int emitter = NoEmitter);
+	void ScheduleSound(class Sound& sound, UINT64 sample_time, float freqMod, float volume, int priority = 0, unsigned int emitter = NoEmitter);
+	UINT64 GetSampleTime() const;
+	double GetAudioTime() const;
+	const unsigned int& GetSampleRate() const;
+	const bool& IsHeadless() const;
+	void Update(float dt);
+	void SetListener(const class Camera2D* pCamera);
+	void SetAttenuation(float min_distance, float max_distance);
+	void SetPanWidth(float width);
+	void SetSpatialThresholds(float gain_threshold, float pan_threshold);
+	unsigned int GetEmitterCount() const;
+	void SetCanonicalFormat(unsigned int sample_rate, unsigned int n_channels);
+	void ClearCanonicalFormat();
+	const std::optional<WAVEFORMATEXTENSIBLE>& GetCanonicalFormat() const;
+	unsigned int GetFormatCount() const;
+	unsigned int GetChannelCount() const;
+	unsigned int GetFreeChannelCount() const;
+	unsigned int GetVirtualVoiceCount() const;
 	void SetMasterVolume(float volume);
 	float GetMasterVolume() const;
 	~SoundSystem();
@@ -0,0 +1,331 @@
+#include "SpriteBatch.h"
+#include "Tile.h"
+#include <algorithm>
+#include <emmintrin.h>
+
+static vec2 SharedFrameSize(const std::vector<Animation>& animations)
+{
+	assert(!animations.empty());
+#ifdef _DEBUG
+	for (const Animation& a : animations)
+	{
+		assert(a.GetFrameSize() == animations.front().GetFrameSize());
+	}
+#endif
+	return vec2(animations.front().GetFrameSize());
+}
+
+SpriteBatch::SpriteBatch(std::vector<Animation>& animations, unsigned int reserve)
+	:
+	animations(animations),
+	frameSize(SharedFrameSize(animations))
+{
+	Reserve(reserve);
+}
+
+unsigned int SpriteBatch::Add(vec2 pos, vec2 vel, unsigned int animation, vec2 scale)
+{
+	assert(animation < animations.size());
+	assert(scale.x > 0.0f && scale.y > 0.0f);
+	const Animation& anim = animations[animation];
+	posX.push_back(pos.x);
+	posY.push_back(pos.y);
+	velX.push_back(vel.x);
+	velY.push_back(vel.y);
+	width.push_back(frameSize.x * scale.x);
+	height.push_back(frameSize.y * scale.y);
+	frameTime.push_back(0.0f);
+	frameIndex.push_back(0.0f);
+	secsPerFrame.push_back(anim.GetSecsPerFrame());
+	nFrames.push_back((float)anim.GetFrameCount());
+	animationIndex.push_back(animation);
+	return GetCount() - 1u;
+}
+
+unsigned int SpriteBatch::Add(const Sprite& sprite, vec2 vel)
+{
+	assert(&sprite.GetAnimation(0u) == &animations.front());
+	const unsigned int index = Add(sprite.GetPosition(), vel, sprite.GetAnimationIndex(), sprite.GetScale());
+	const Animation& anim = sprite.GetAnimation(sprite.GetAnimationIndex());
+	frameIndex[index] = (float)anim.GetCurrentFrameIndex();
+	frameTime[index] = anim.GetCurrentFrameTime();
+	return index;
+}
+
+void SpriteBatch::Remove(unsigned int index)
+{
+	assert(index < GetCount());
+	const unsigned int last = GetCount() - 1u;
+	posX[index] = posX[last];
+	posY[index] = posY[last];
+	velX[index] = velX[last];
+	velY[index] = velY[last];
+	width[index] = width[last];
+	height[index] = height[last];
+	frameTime[index] = frameTime[last];
+	frameIndex[index] = frameIndex[last];
+	secsPerFrame[index] = secsPerFrame[last];
+	nFrames[index] = nFrames[last];
+	animationIndex[index] = animationIndex[last];
+	posX.pop_back();
+	posY.pop_back();
+	velX.pop_back();
+	velY.pop_back();
+	width.pop_back();
+	height.pop_back();
+	frameTime.pop_back();
+	frameIndex.pop_back();
+	secsPerFrame.pop_back();
+	nFrames.pop_back();
+	animationIndex.pop_back();
+}
+
+void SpriteBatch::Clear()
+{
+	posX.clear();
+	posY.clear();
+	velX.clear();
+	velY.clear();
+	width.clear();
+	height.clear();
+	frameTime.clear();
+	frameIndex.clear();
+	secsPerFrame.clear();
+	nFrames.clear();
+	animationIndex.clear();
+}
+
+void SpriteBatch::Reserve(unsigned int count)
+{
+	posX.reserve(count);
+	posY.reserve(count);
+	velX.reserve(count);
+	velY.reserve(count);
+	width.reserve(count);
+	height.reserve(count);
+	frameTime.reserve(count);
+	frameIndex.reserve(count);
+	secsPerFrame.reserve(count);
+	nFrames.reserve(count);
+	animationIndex.reserve(count);
+}
+
+unsigned int SpriteBatch::GetCount() const
+{
+	return (unsigned int)posX.size();
+}
+
+bool SpriteBatch::IsEmpty() const
+{
+	return posX.empty();
+}
+
+void SpriteBatch::Move(unsigned int index, vec2 delta)
+{
+	assert(index < GetCount());
+	posX[index] += delta.x;
+	posY[index] += delta.y;
+}
+
+void SpriteBatch::SetPosition(unsigned int index, vec2 pos)
+{
+	assert(index < GetCount());
+	posX[index] = pos.x;
+	posY[index] = pos.y;
+}
+
+vec2 SpriteBatch::GetPosition(unsigned int index) const
+{
+	assert(index < GetCount());
+	return vec2(posX[index], posY[index]);
+}
+
+void SpriteBatch::SetVelocity(unsigned int index, vec2 vel)
+{
+	assert(index < GetCount());
+	velX[index] = vel.x;
+	velY[index] = vel.y;
+}
+
+vec2 SpriteBatch::GetVelocity(unsigned int index) const
+{
+	assert(index < GetCount());
+	return vec2(velX[index], velY[index]);
+}
+
+void SpriteBatch::SetScale(unsigned int index, vec2 scale)
+{
+	assert(index < GetCount());
+	assert(scale.x > 0.0f && scale.y > 0.0f);
+	width[index] = frameSize.x * scale.x;
+	height[index] = frameSize.y * scale.y;
+}
+
+vec2 SpriteBatch::GetScale(unsigned int index) const
+{
+	return GetSize(index) / frameSize;
+}
+
+vec2 SpriteBatch::GetSize(unsigned int index) const
+{
+	assert(index < GetCount());
+	return vec2(width[index], height[index]);
+}
+
+fRect SpriteBatch::GetRect(unsigned int index) const
+{
+	assert(index < GetCount());
+	return fRect({ posX[index],posY[index] }, width[index], height[index]);
+}
+
+void SpriteBatch::SetAnimationIndex(unsigned int index, unsigned int animation)
+{
+	assert(index < GetCount());
+	assert(animation < animations.size());
+	const Animation& anim = animations[animation];
+	animationIndex[index] = animation;
+	secsPerFrame[index] = anim.GetSecsPerFrame();
+	nFrames[index] = (float)anim.GetFrameCount();
+	frameIndex[index] = 0.0f;
+	frameTime[index] = 0.0f;
+}
+
+const unsigned int& SpriteBatch::GetAnimationIndex(unsigned int index) const
+{
+	assert(index < GetCount());
+	return animationIndex[index];
+}
+
+unsigned int SpriteBatch::GetFrameIndex(unsigned int index) const
+{
+	assert(index < GetCount());
+	return (unsigned int)frameIndex[index];
+}
+
+const Image& SpriteBatch::GetCurrentImage(unsigned int index) const
+{
+	assert(index < GetCount());
+	return animations[animationIndex[index]].GetFrame((unsigned int)frameIndex[index]);
+}
+
+bool SpriteBatch::CollidedWith(unsigned int index, const Sprite& sprite) const
+{
+	const fRect rect = GetRect(index);
+	if (sprite.HasHitBoxes())
+	{
+		for (const fRect& hb : sprite.GetHitBoxes())
+		{
+			if (rect.IsTouching(hb))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+	else
+	{
+		return rect.IsTouching(sprite.GetRect());
+	}
+}
+
+bool SpriteBatch::CollidedWith(unsigned int index, const Tile& tile) const
+{
+	const fRect rect = GetRect(index);
+	if (tile.HasHitBoxes())
+	{
+		for (const fRect& hb : tile.GetHitBoxes())
+		{
+			if (rect.IsTouching(hb))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+	else
+	{
+		return rect.IsTouching(tile.GetRect());
+	}
+}
+
+void SpriteBatch::Update(float time_ellapsed)
+{
+	const unsigned int count = GetCount();
+	const unsigned int simdCount = count & ~3u;
+	const __m128 dt = _mm_set1_ps(time_ellapsed);
+	const __m128 zero = _mm_setzero_ps();
+	for (unsigned int i = 0u; i < simdCount; i += 4u)
+	{
+		_mm_storeu_ps(&posX[i], _mm_add_ps(_mm_loadu_ps(&posX[i]), _mm_mul_ps(_mm_loadu_ps(&velX[i]), dt)));
+		_mm_storeu_ps(&posY[i], _mm_add_ps(_mm_loadu_ps(&posY[i]), _mm_mul_ps(_mm_loadu_ps(&velY[i]), dt)));
+		const __m128 spf = _mm_loadu_ps(&secsPerFrame[i]);
+		const __m128 frames = _mm_loadu_ps(&nFrames[i]);
+		__m128 time = _mm_add_ps(_mm_loadu_ps(&frameTime[i]), dt);
+		const __m128 advance = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_div_ps(time, spf)));
+		time = _mm_max_ps(_mm_sub_ps(time, _mm_mul_ps(advance, spf)), zero);
+		__m128 frame = _mm_add_ps(_mm_loadu_ps(&frameIndex[i]), advance);
+		frame = _mm_sub_ps(frame, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_div_ps(frame, frames))), frames));
+		_mm_storeu_ps(&frameTime[i], time);
+		_mm_storeu_ps(&frameIndex[i], frame);
+	}
+	for (unsigned int i = simdCount; i < count; ++i)
+	{
+		posX[i] += velX[i] * time_ellapsed;
+		posY[i] += velY[i] * time_ellapsed;
+		const float time = frameTime[i] + time_ellapsed;
+		const float advance = (float)(int)(time / secsPerFrame[i]);
+		frameTime[i] = std::max(time - advance * secsPerFrame[i], 0.0f);
+		const float frame = frameIndex[i] + advance;
+		frameIndex[i] = frame - (float)(int)(frame / nFrames[i]) * nFrames[i];
+	}
+}
+
+unsigned int SpriteBatch::Draw(Graphics& gfx, unsigned int layer) const
+{
+	const float layerWidth = gfx.GetWidth_FLOAT(layer);
+	const float layerHeight = gfx.GetHeight_FLOAT(layer);
+	const unsigned int count = GetCount();
+	unsigned int nDrawn = 0u;
+	for (unsigned int i = 0u; i < count; ++i)
+	{
+		if (posX[i] < layerWidth && posX[i] + width[i] > 0.0f && posY[i] < layerHeight && posY[i] + height[i] > 0.0f)
+		{
+			const Image& frame = animations[animationIndex[i]].GetFrame((unsigned int)frameIndex[i]);
+			if (width[i] != frameSize.x || height[i] != frameSize.y)
+			{
+				frame.Draw(gfx, (int)posX[i], (int)posY[i], (unsigned int)width[i], (unsigned int)height[i], layer);
+			}
+			else
+			{
+				frame.Draw(gfx, (int)posX[i], (int)posY[i], layer);
+			}
+			++nDrawn;
+		}
+	}
+	return nDrawn;
+}
+
+unsigned int SpriteBatch::DrawWithTransparency(Graphics& gfx, unsigned int layer) const
+{
+	const float layerWidth = gfx.GetWidth_FLOAT(layer);
+	const float layerHeight = gfx.GetHeight_FLOAT(layer);
+	const unsigned int count = GetCount();
+	unsigned int nDrawn = 0u;
+	for (unsigned int i = 0u; i < count; ++i)
+	{
+		if (posX[i] < layerWidth && posX[i] + width[i] > 0.0f && posY[i] < layerHeight && posY[i] + height[i] > 0.0f)
+		{
+			const Image& frame = animations[animationIndex[i]].GetFrame((unsigned int)frameIndex[i]);
+			if (width[i] != frameSize.x || height[i] != frameSize.y)
+			{
+				frame.DrawWithTransparency(gfx, (int)posX[i], (int)posY[i], (unsigned int)width[i], (unsigned int)height[i], layer);
+			}
+			else
+			{
+				frame.DrawWithTransparency(gfx, (int)posX[i], (int)posY[i], layer);
+			}
+			++nDrawn;
+		}
+	}
+	return nDrawn;
+}
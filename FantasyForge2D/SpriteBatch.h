@@ -0,0 +1,48 @@
+#pragma once
+#include "Sprite.h"
+
+class SpriteBatch
+{
+private:
+	std::vector<Animation>& animations;
+	const vec2 frameSize;
+	std::vector<float> posX;
+	std::vector<float> posY;
+	std::vector<float> velX;
+	std::vector<float> velY;
+	std::vector<float> width;
+	std::vector<float> height;
+	std::vector<float> frameTime;
+	std::vector<float> frameIndex;
+	std::vector<float> secsPerFrame;
+	std::vector<float> nFrames;
+	std::vector<unsigned int> animationIndex;
+public:
+	SpriteBatch() = delete;
+	SpriteBatch(std::vector<Animation>& animations, unsigned int reserve = 0u);
+	unsigned int Add(vec2 pos, vec2 vel, unsigned int animation = 0u, vec2 scale = { 1.0f,1.0f });
+	unsigned int Add(const Sprite& sprite, vec2 vel = { 0.0f,0.0f });
+	void Remove(unsigned int index);
+	void Clear();
+	void Reserve(unsigned int count);
+	unsigned int GetCount() const;
+	bool IsEmpty() const;
+	void Move(unsigned int index, vec2 delta);
+	void SetPosition(unsigned int index, vec2 pos);
+	vec2 GetPosition(unsigned int index) const;
+	void SetVelocity(unsigned int index, vec2 vel);
+	vec2 GetVelocity(unsigned int index) const;
+	void SetScale(unsigned int index, vec2 scale);
+	vec2 GetScale(unsigned int index) const;
+	vec2 GetSize(unsigned int index) const;
+	fRect GetRect(unsigned int index) const;
+	void SetAnimationIndex(unsigned int index, unsigned int animation);
+	const unsigned int& GetAnimationIndex(unsigned int index) const;
+	unsigned int GetFrameIndex(unsigned int index) const;
+	const Image& GetCurrentImage(unsigned int index) const;
+	bool CollidedWith(unsigned int index, const Sprite& sprite) const;
+	bool CollidedWith(unsigned int index, const Tile& tile) const;
+	void Update(float time_ellapsed);
+	unsigned int Draw(Graphics& gfx, unsigned int layer = 0u) const;
+	unsigned int DrawWithTransparency(Graphics& gfx, unsigned int layer = 0u) const;
+};
@@ -0,0 +1,372 @@
+#include "StreamingSound.h"
+
+static const SoundBank::Entry& FindEntry(const SoundBank& bank, const char* name)
+{
+	const SoundBank::Entry* pEntry = bank.Find(name);
+	if (!pEntry)
+	{
+		throw SNDEXCPT("Sound not found in sound bank!\n" + std::string(name));
+	}
+	return *pEntry;
+}
+
+static WAVEFORMATEX DecodedFormat(const SoundBank::Entry& entry)
+{
+	WAVEFORMATEX format;
+	ZeroMemory(&format, sizeof(format));
+	format.wFormatTag = WAVE_FORMAT_PCM;
+	format.nChannels = WORD(entry.nChannels);
+	format.nSamplesPerSec = entry.sampleRate;
+	format.wBitsPerSample = 16;
+	format.nBlockAlign = WORD(entry.nChannels * 2u);
+	format.nAvgBytesPerSec = entry.sampleRate * format.nBlockAlign;
+	return format;
+}
+
+void STDMETHODCALLTYPE StreamingSound::VoiceCallback::OnStreamEnd()
+{
+	stream.hasFinished = true;
+	stream.isStreaming = false;
+}
+
+void STDMETHODCALLTYPE StreamingSound::VoiceCallback::OnBufferEnd(void* pBufferContext)
+{
+	--stream.nQueued;
+	stream.refillCV.notify_one();
+}
+
+void StreamingSound::Refill()
+{
+	std::unique_lock<std::mutex> lock(streamMutex);
+	while (isRunning)
+	{
+		refillCV.wait_for(lock, std::chrono::milliseconds(10), [this]()
+			{
+				return !isRunning || (isStreaming && !reachedEnd && nQueued < nBuffers);
+			});
+		while (isRunning && isStreaming && !reachedEnd && nQueued < nBuffers)
+		{
+			SubmitChunk();
+		}
+	}
+}
+
+void StreamingSound::SubmitChunk()
+{
+	BYTE* pChunk = pBuffers.get() + nextBuffer * chunkSize;
+	const UINT32 nBytes = std::min(chunkSize, dataSize - readPosition);
+	if (pBank)
+	{
+		pBank->Decode(*pEntry, readPosition / format.nBlockAlign, nBytes / format.nBlockAlign, reinterpret_cast<short*>(pChunk));
+	}
+	else
+	{
+		memcpy(pChunk, wave->GetData() + readPosition, nBytes);
+	}
+	readPosition += nBytes;
+	XAUDIO2_BUFFER buffer;
+	ZeroMemory(&buffer, sizeof(buffer));
+	buffer.pAudioData = pChunk;
+	buffer.AudioBytes = nBytes;
+	if (readPosition >= dataSize)
+	{
+		if (isLooping)
+		{
+			readPosition = 0u;
+		}
+		else
+		{
+			buffer.Flags = XAUDIO2_END_OF_STREAM;
+			reachedEnd = true;
+		}
+	}
+	++nQueued;
+	nextBuffer = (nextBuffer + 1u) % nBuffers;
+	if (FAILED(pVoice->SubmitSourceBuffer(&buffer, nullptr)))
+	{
+		--nQueued;
+		isStreaming = false;
+	}
+}
+
+void StreamingSound::FlushAndSeek(UINT32 sample)
+{
+	if (pVoice)
+	{
+		SNDCHECK(pVoice->Stop());
+		SNDCHECK(pVoice->FlushSourceBuffers());
+		XAUDIO2_VOICE_STATE state;
+		pVoice->GetState(&state);
+		samplesPlayedAtSeek = state.SamplesPlayed;
+	}
+	else
+	{
+		simPlayed = 0.0;
+		simClock = SoundSystem::Get().GetSampleTime();
+	}
+	basePosition = sample;
+	readPosition = sample * format.nBlockAlign;
+	reachedEnd = false;
+	hasFinished = false;
+}
+
+UINT64 StreamingSound::GetSamplesPlayed() const
+{
+	if (!pVoice)
+	{
+		const SoundSystem& soundSys = SoundSystem::Get();
+		const UINT64 now = soundSys.GetSampleTime();
+		if (isStreaming && !isPaused)
+		{
+			simPlayed += double(now - simClock) * double(format.nSamplesPerSec) * double(freqMod) / double(soundSys.GetSampleRate());
+		}
+		simClock = now;
+		return basePosition + UINT64(simPlayed);
+	}
+	XAUDIO2_VOICE_STATE state;
+	pVoice->GetState(&state);
+	std::lock_guard<std::mutex> lock(streamMutex);
+	if (state.SamplesPlayed < samplesPlayedAtSeek)
+	{
+		samplesPlayedAtSeek = 0u;
+	}
+	return basePosition + (state.SamplesPlayed - samplesPlayedAtSeek);
+}
+
+StreamingSound::StreamingSound(const char* fileName, bool loop, float freqMod, float volume)
+	:
+	wave(std::in_place, fileName),
+	format(wave->GetFormat()),
+	dataSize(wave->GetDataSize()),
+	chunkSize(BufferSize - BufferSize % format.nBlockAlign),
+	isLooping(loop),
+	callback(*this),
+	freqMod(freqMod),
+	volume(volume)
+{
+	CreateVoice();
+}
+
+StreamingSound::StreamingSound(const SoundBank& bank, const char* name, bool loop, float freqMod, float volume)
+	:
+	pBank(&bank),
+	pEntry(&FindEntry(bank, name)),
+	format(DecodedFormat(*pEntry)),
+	dataSize(pEntry->nFrames * format.nBlockAlign),
+	chunkSize(std::max(BufferSize - BufferSize % (pEntry->blockFrames * format.nBlockAlign), pEntry->blockFrames * format.nBlockAlign)),
+	isLooping(loop),
+	callback(*this),
+	freqMod(freqMod),
+	volume(volume)
+{
+	CreateVoice();
+}
+
+void StreamingSound::CreateVoice()
+{
+	SoundSystem& soundSys = SoundSystem::Get();
+	if (soundSys.IsHeadless())
+	{
+		simClock = soundSys.GetSampleTime();
+		return;
+	}
+	pBuffers = std::make_unique<BYTE[]>(chunkSize * nBuffers);
+	SNDCHECK(soundSys.pEngine->CreateSourceVoice(&pVoice, &format, 0u, 2.0f, &callback));
+	SNDCHECK(pVoice->SetFrequencyRatio(freqMod));
+	SNDCHECK(pVoice->SetVolume(volume));
+	readPosition = 0u;
+	refillThread = std::thread(&StreamingSound::Refill, this);
+}
+
+void StreamingSound::Play()
+{
+	if (!pVoice)
+	{
+		if (HasFinished())
+		{
+			FlushAndSeek(0u);
+		}
+		GetSamplesPlayed();
+		isStreaming = true;
+		isPaused = false;
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(streamMutex);
+		if (hasFinished)
+		{
+			FlushAndSeek(0u);
+		}
+		isStreaming = true;
+		while (isStreaming && !reachedEnd && nQueued < nBuffers)
+		{
+			SubmitChunk();
+		}
+	}
+	isPaused = false;
+	SNDCHECK(pVoice->Start());
+}
+
+void StreamingSound::Pause()
+{
+	assert(isStreaming && "Stream is not playing");
+	if (!pVoice)
+	{
+		GetSamplesPlayed();
+		isPaused = true;
+		return;
+	}
+	SNDCHECK(pVoice->Stop());
+	isPaused = true;
+}
+
+void StreamingSound::Resume()
+{
+	assert(isPaused && "Stream was not paused");
+	if (!pVoice)
+	{
+		GetSamplesPlayed();
+		isPaused = false;
+		return;
+	}
+	SNDCHECK(pVoice->Start());
+	isPaused = false;
+}
+
+void StreamingSound::Stop()
+{
+	if (!pVoice)
+	{
+		isStreaming = false;
+		isPaused = false;
+		FlushAndSeek(0u);
+		return;
+	}
+	std::lock_guard<std::mutex> lock(streamMutex);
+	isStreaming = false;
+	isPaused = false;
+	FlushAndSeek(0u);
+}
+
+void StreamingSound::Seek(float seconds)
+{
+	SeekSample(UINT32(std::max(seconds, 0.0f) * float(format.nSamplesPerSec)));
+}
+
+void StreamingSound::SeekSample(UINT32 sample)
+{
+	sample = std::min(sample, GetSampleCount());
+	if (!pVoice)
+	{
+		FlushAndSeek(sample);
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock(streamMutex);
+		const bool wasStreaming = isStreaming;
+		FlushAndSeek(sample);
+		isStreaming = wasStreaming;
+	}
+	refillCV.notify_one();
+	if (isStreaming && !isPaused)
+	{
+		SNDCHECK(pVoice->Start());
+	}
+}
+
+void StreamingSound::SetLooping(bool loop)
+{
+	isLooping = loop;
+}
+
+bool StreamingSound::IsLooping() const
+{
+	return isLooping;
+}
+
+void StreamingSound::SetVolume(float volume)
+{
+	this->volume = volume;
+	if (pVoice)
+	{
+		SNDCHECK(pVoice->SetVolume(volume));
+	}
+}
+
+const float& StreamingSound::GetVolume() const
+{
+	return volume;
+}
+
+void StreamingSound::SetFrequencyRatio(float freqMod)
+{
+	if (!pVoice)
+	{
+		GetSamplesPlayed();
+		this->freqMod = freqMod;
+		return;
+	}
+	this->freqMod = freqMod;
+	SNDCHECK(pVoice->SetFrequencyRatio(freqMod));
+}
+
+const WAVEFORMATEX& StreamingSound::GetFormat() const
+{
+	return format;
+}
+
+UINT32 StreamingSound::GetSampleCount() const
+{
+	return dataSize / format.nBlockAlign;
+}
+
+UINT32 StreamingSound::GetSamplePosition() const
+{
+	if (HasFinished())
+	{
+		return GetSampleCount();
+	}
+	const UINT64 played = GetSamplesPlayed();
+	return UINT32(isLooping ? played % GetSampleCount() : std::min(played, UINT64(GetSampleCount())));
+}
+
+float StreamingSound::GetDuration() const
+{
+	return float(GetSampleCount()) / float(format.nSamplesPerSec);
+}
+
+float StreamingSound::GetPosition() const
+{
+	return float(GetSamplePosition()) / float(format.nSamplesPerSec);
+}
+
+bool StreamingSound::IsPlaying() const
+{
+	return isStreaming && !isPaused && (pVoice || !HasFinished());
+}
+
+bool StreamingSound::IsPaused() const
+{
+	return isPaused;
+}
+
+bool StreamingSound::HasFinished() const
+{
+	return hasFinished || (!pVoice && !isLooping && GetSamplesPlayed() >= GetSampleCount());
+}
+
+StreamingSound::~StreamingSound()
+{
+	isRunning = false;
+	refillCV.notify_one();
+	if (refillThread.joinable())
+	{
+		refillThread.join();
+	}
+	if (pVoice)
+	{
+		pVoice->Stop();
+		pVoice->DestroyVoice();
+		pVoice = nullptr;
+	}
+}
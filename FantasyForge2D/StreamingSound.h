@@ -0,0 +1,94 @@
+#pragma once
+#include "SoundSystem.h"
+#include "SoundBank.h"
+#include "WaveFile.h"
+#include <optional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+class StreamingSound
+{
+public:
+	static constexpr unsigned int nBuffers = 3u;
+	static constexpr unsigned int BufferSize = 65536u;
+private:
+	class VoiceCallback : public IXAudio2VoiceCallback
+	{
+	private:
+		StreamingSound& stream;
+	public:
+		VoiceCallback(StreamingSound& stream)
+			:
+			stream(stream)
+		{}
+		void STDMETHODCALLTYPE OnStreamEnd() override;
+		void STDMETHODCALLTYPE OnVoiceProcessingPassEnd() override {}
+		void STDMETHODCALLTYPE OnVoiceProcessingPassStart(UINT32 samplesRequired) override {}
+		void STDMETHODCALLTYPE OnBufferEnd(void* pBufferContext) override;
+		void STDMETHODCALLTYPE OnBufferStart(void* pBufferContext) override {}
+		void STDMETHODCALLTYPE OnLoopEnd(void* pBufferContext) override {}
+		void STDMETHODCALLTYPE OnVoiceError(void* pBufferContext, HRESULT error) override {}
+	};
+private:
+	std::optional<WaveFile> wave;
+	const SoundBank* pBank = nullptr;
+	const SoundBank::Entry* pEntry = nullptr;
+	WAVEFORMATEX format;
+	UINT32 dataSize;
+	UINT32 chunkSize;
+	std::unique_ptr<BYTE[]> pBuffers;
+	unsigned int nextBuffer = 0u;
+	UINT32 readPosition = 0u;
+	bool reachedEnd = false;
+	std::atomic<unsigned int> nQueued = 0u;
+	std::atomic<bool> isStreaming = false;
+	std::atomic<bool> isPaused = false;
+	std::atomic<bool> hasFinished = false;
+	std::atomic<bool> isLooping;
+	std::atomic<bool> isRunning = true;
+	UINT64 basePosition = 0u;
+	mutable UINT64 samplesPlayedAtSeek = 0u;
+	mutable double simPlayed = 0.0;
+	mutable UINT64 simClock = 0u;
+	mutable std::mutex streamMutex;
+	std::condition_variable refillCV;
+	VoiceCallback callback;
+	IXAudio2SourceVoice* pVoice = nullptr;
+	float freqMod;
+	float volume;
+	std::thread refillThread;
+private:
+	void CreateVoice();
+	void Refill();
+	void SubmitChunk();
+	void FlushAndSeek(UINT32 sample);
+	UINT64 GetSamplesPlayed() const;
+public:
+	StreamingSound() = delete;
+	StreamingSound(const char* fileName, bool loop = false, float freqMod = 1.0f, float volume = 1.0f);
+	StreamingSound(const SoundBank& bank, const char* name, bool loop = false, float freqMod = 1.0f, float volume = 1.0f);
+	StreamingSound(const StreamingSound& stream) = delete;
+	StreamingSound operator =(const StreamingSound& stream) = delete;
+	void Play();
+	void Pause();
+	void Resume();
+	void Stop();
+	void Seek(float seconds);
+	void SeekSample(UINT32 sample);
+	void SetLooping(bool loop);
+	bool IsLooping() const;
+	void SetVolume(float volume);
+	const float& GetVolume() const;
+	void SetFrequencyRatio(float freqMod);
+	const WAVEFORMATEX& GetFormat() const;
+	UINT32 GetSampleCount() const;
+	UINT32 GetSamplePosition() const;
+	float GetDuration() const;
+	float GetPosition() const;
+	bool IsPlaying() const;
+	bool IsPaused() const;
+	bool HasFinished() const;
+	~StreamingSound();
+};
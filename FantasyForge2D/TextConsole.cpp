@@ -0,0 +1,200 @@
+#include "TextConsole.h"
+#include <algorithm>
+#include <assert.h>
+
+TextConsole::TextConsole(const GraphicText& font, uint2 console_dim, unsigned int history_lines, Color color, unsigned int scale)
+	:
+	pCharset(font.GetCharset()),
+	nColumns(console_dim.x),
+	nRows(console_dim.y),
+	capacity(std::max(history_lines, console_dim.y)),
+	textScale(scale),
+	charWidth(pCharset->GetCharacterWidth() * scale),
+	lineWidth(console_dim.x * pCharset->GetCharacterWidth() * scale),
+	lineHeight(pCharset->GetCharacterHeight() * scale),
+	lines(),
+	lineLengths(),
+	newestLine(0u),
+	nLines(1u),
+	cursorX(0u),
+	scrollOffset(0u),
+	textColor(color)
+{
+	assert(nColumns > 0u && nRows > 0u);
+	assert(scale > 0u);
+	lines.resize(capacity * lineHeight * lineWidth, Colors::Transparent);
+	lineLengths.resize(capacity, 0u);
+}
+
+Color* TextConsole::GetLine(unsigned int slot)
+{
+	return &lines[slot * lineHeight * lineWidth];
+}
+
+const Color* TextConsole::GetLine(unsigned int slot) const
+{
+	return &lines[slot * lineHeight * lineWidth];
+}
+
+unsigned int TextConsole::GetVisibleSlot(unsigned int row) const
+{
+	const unsigned int nVisible = std::min(nRows, nLines);
+	const unsigned int linesBack = scrollOffset + (nVisible - 1u - row);
+	return (newestLine + capacity - linesBack) % capacity;
+}
+
+template <bool transparent>
+void TextConsole::Composite(Graphics& gfx, int X, int Y, unsigned int layer) const
+{
+	const int layerWidth = (int)gfx.GetWidth(layer);
+	const int layerHeight = (int)gfx.GetHeight(layer);
+	const int startX = std::max(X, 0);
+	const int endX = std::min(X + (int)lineWidth, layerWidth);
+	if (startX >= endX)
+	{
+		return;
+	}
+	Color* pPaper = gfx.GetPixelMap(layer).data();
+	const unsigned int nVisible = std::min(nRows, nLines);
+	for (unsigned int row = 0u; row < nVisible; ++row)
+	{
+		const unsigned int slot = GetVisibleSlot(row);
+		const Color* pLine = GetLine(slot);
+		const int lineY = Y + (int)(row * lineHeight);
+		const int startY = std::max(lineY, 0);
+		const int endY = std::min(lineY + (int)lineHeight, layerHeight);
+		const int textEndX = std::clamp(X + (int)(lineLengths[slot] * charWidth), startX, endX);
+		for (int y = startY; y < endY; ++y)
+		{
+			const Color* pSrc = &pLine[(y - lineY) * lineWidth + (startX - X)];
+			Color* pDst = &pPaper[y * layerWidth + startX];
+			if constexpr (transparent)
+			{
+				for (int x = 0; x < textEndX - startX; ++x)
+				{
+					if (pSrc[x].GetA())
+					{
+						pDst[x] = pSrc[x];
+					}
+				}
+			}
+			else
+			{
+				memcpy(pDst, pSrc, (textEndX - startX) * sizeof(Color));
+				std::fill(pDst + (textEndX - startX), pDst + (endX - startX), Colors::Transparent);
+			}
+		}
+	}
+}
+
+void TextConsole::Print(const std::string& text)
+{
+	for (const char& chr : text)
+	{
+		if (chr == '\n')
+		{
+			NewLine();
+			continue;
+		}
+		else if (chr == '\r')
+		{
+			cursorX = 0u;
+			continue;
+		}
+		assert(pCharset->HasChar((unsigned char)chr));
+		if (cursorX == nColumns)
+		{
+			NewLine();
+		}
+		pCharset->RasterizeChar((unsigned char)chr - pCharset->GetStartChar(), &GetLine(newestLine)[cursorX * charWidth], lineWidth, textColor, nullptr, textScale);
+		++cursorX;
+		lineLengths[newestLine] = std::max(lineLengths[newestLine], cursorX);
+	}
+}
+
+void TextConsole::PrintLine(const std::string& text)
+{
+	Print(text);
+	NewLine();
+}
+
+void TextConsole::NewLine()
+{
+	newestLine = (newestLine + 1u) % capacity;
+	lineLengths[newestLine] = 0u;
+	nLines = std::min(nLines + 1u, capacity);
+	cursorX = 0u;
+	if (scrollOffset > 0u)
+	{
+		scrollOffset = std::min(scrollOffset + 1u, GetMaxScrollOffset());
+	}
+}
+
+void TextConsole::Clear()
+{
+	std::fill(lineLengths.begin(), lineLengths.end(), 0u);
+	newestLine = 0u;
+	nLines = 1u;
+	cursorX = 0u;
+	scrollOffset = 0u;
+}
+
+void TextConsole::SetTextColor(const Color& color)
+{
+	textColor = color;
+}
+
+const Color& TextConsole::GetTextColor() const
+{
+	return textColor;
+}
+
+void TextConsole::ScrollUp(unsigned int n_lines)
+{
+	scrollOffset = std::min(scrollOffset + n_lines, GetMaxScrollOffset());
+}
+
+void TextConsole::ScrollDown(unsigned int n_lines)
+{
+	scrollOffset -= std::min(scrollOffset, n_lines);
+}
+
+void TextConsole::ScrollToBottom()
+{
+	scrollOffset = 0u;
+}
+
+const unsigned int& TextConsole::GetScrollOffset() const
+{
+	return scrollOffset;
+}
+
+unsigned int TextConsole::GetMaxScrollOffset() const
+{
+	return nLines - std::min(nRows, nLines);
+}
+
+const unsigned int& TextConsole::GetLineCount() const
+{
+	return nLines;
+}
+
+const unsigned int& TextConsole::GetCapacity() const
+{
+	return capacity;
+}
+
+vec2u TextConsole::GetDimensions() const
+{
+	return { lineWidth,nRows * lineHeight };
+}
+
+void TextConsole::Draw(Graphics& gfx, int X, int Y, unsigned int layer) const
+{
+	Composite<false>(gfx, X, Y, layer);
+}
+
+void TextConsole::DrawWithTransparency(Graphics& gfx, int X, int Y, unsigned int layer) const
+{
+	Composite<true>(gfx, X, Y, layer);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "GraphicText.h"
+#include <string>
+
+class TextConsole
+{
+private:
+	std::shared_ptr<const Charset> pCharset;
+	const unsigned int nColumns;
+	const unsigned int nRows;
+	const unsigned int capacity;
+	const unsigned int textScale;
+	const unsigned int charWidth;
+	const unsigned int lineWidth;
+	const unsigned int lineHeight;
+	std::vector<Color> lines;
+	std::vector<unsigned int> lineLengths;
+	unsigned int newestLine;
+	unsigned int nLines;
+	unsigned int cursorX;
+	unsigned int scrollOffset;
+	Color textColor;
+private:
+	Color* GetLine(unsigned int slot);
+	const Color* GetLine(unsigned int slot) const;
+	unsigned int GetVisibleSlot(unsigned int row) const;
+	template <bool transparent>
+	void Composite(Graphics& gfx, int X, int Y, unsigned int layer) const;
+public:
+	TextConsole() = delete;
+	TextConsole(const GraphicText& font, uint2 console_dim, unsigned int history_lines, Color color = Colors::White, unsigned int scale = 1u);
+	void Print(const std::string& text);
+	void PrintLine(const std::string& text);
+	void NewLine();
+	void Clear();
+	void SetTextColor(const Color& color);
+	const Color& GetTextColor() const;
+	void ScrollUp(unsigned int n_lines = 1u);
+	void ScrollDown(unsigned int n_lines = 1u);
+	void ScrollToBottom();
+	const unsigned int& GetScrollOffset() const;
+	unsigned int GetMaxScrollOffset() const;
+	const unsigned int& GetLineCount() const;
+	const unsigned int& GetCapacity() const;
+	vec2u GetDimensions() const;
+	void Draw(Graphics& gfx, int X, int Y, unsigned int layer = 0u) const;
+	void DrawWithTransparency(Graphics& gfx, int X, int Y, unsigned int layer = 0u) const;
+};
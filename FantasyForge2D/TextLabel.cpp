@@ -0,0 +1,152 @@
+#include "TextLabel.h"
+#include <assert.h>
+
+TextLabel::TextLabel(const GraphicText& font, std::string text, Color color, unsigned int scale)
+	:
+	pCharset(font.GetCharset()),
+	text(text),
+	textColor(color),
+	textScale(scale),
+	textTexture(),
+	isUsingTexture(false),
+	image(),
+	renderedText(),
+	isStyleDirty(true)
+{
+	assert(scale > 0u);
+}
+
+void TextLabel::Render() const
+{
+	const unsigned int charWidth = pCharset->GetCharacterWidth() * textScale;
+	const unsigned int charHeight = pCharset->GetCharacterHeight() * textScale;
+	if (isStyleDirty || text.length() != renderedText.length())
+	{
+		Image resized((unsigned int)text.length() * charWidth, charHeight);
+		if (isStyleDirty)
+		{
+			renderedText.clear();
+		}
+		else
+		{
+			renderedText.resize(std::min(text.length(), renderedText.length()));
+			const unsigned int keptBytes = (unsigned int)renderedText.length() * charWidth * sizeof(Color);
+			for (unsigned int y = 0u; y < charHeight; ++y)
+			{
+				memcpy(&resized.GetPtrToImage()[y * resized.GetWidth()], &image.GetPtrToImage()[y * image.GetWidth()], keptBytes);
+			}
+		}
+		image = resized;
+	}
+	const Color* pTexture = isUsingTexture ? textTexture->GetPtrToImage() : nullptr;
+	for (unsigned int i = 0u; i < text.length(); ++i)
+	{
+		if (i >= renderedText.length() || renderedText[i] != text[i])
+		{
+			assert(pCharset->HasChar((unsigned char)text[i]));
+			pCharset->RasterizeChar((unsigned char)text[i] - pCharset->GetStartChar(), &image.GetPtrToImage()[i * charWidth], image.GetWidth(), textColor, pTexture, textScale);
+		}
+	}
+	renderedText = text;
+	isStyleDirty = false;
+}
+
+void TextLabel::SetText(std::string new_text)
+{
+	text = new_text;
+}
+
+const std::string& TextLabel::GetText() const
+{
+	return text;
+}
+
+void TextLabel::SetTextColor(const Color& color)
+{
+	if (color != textColor || isUsingTexture)
+	{
+		textColor = color;
+		isUsingTexture = false;
+		isStyleDirty = true;
+	}
+}
+
+const Color& TextLabel::GetTextColor() const
+{
+	return textColor;
+}
+
+void TextLabel::SetTextScale(unsigned int scale)
+{
+	assert(scale > 0u);
+	if (scale != textScale)
+	{
+		textScale = scale;
+		isStyleDirty = true;
+	}
+}
+
+const unsigned int& TextLabel::GetTextScale() const
+{
+	return textScale;
+}
+
+void TextLabel::SetTextTexture(const Image& texture)
+{
+	assert(texture.GetWidth() == pCharset->GetCharacterWidth());
+	assert(texture.GetHeight() == pCharset->GetCharacterHeight());
+	textTexture = texture;
+	isUsingTexture = true;
+	isStyleDirty = true;
+}
+
+void TextLabel::UseTextTexture()
+{
+	assert(textTexture);
+	if (!isUsingTexture)
+	{
+		isUsingTexture = true;
+		isStyleDirty = true;
+	}
+}
+
+void TextLabel::UseTextColor()
+{
+	if (isUsingTexture)
+	{
+		isUsingTexture = false;
+		isStyleDirty = true;
+	}
+}
+
+bool TextLabel::IsUsingTextTexture() const
+{
+	return isUsingTexture;
+}
+
+bool TextLabel::IsDirty() const
+{
+	return isStyleDirty || text != renderedText;
+}
+
+vec2u TextLabel::GetDimensions() const
+{
+	return { (unsigned int)text.length() * pCharset->GetCharacterWidth() * textScale,pCharset->GetCharacterHeight() * textScale };
+}
+
+const Image& TextLabel::GetImage() const
+{
+	if (IsDirty())
+	{
+		Render();
+	}
+	return image;
+}
+
+void TextLabel::Draw(Graphics& gfx, int X, int Y, unsigned int layer) const
+{
+	if (!text.empty())
+	{
+		GetImage().DrawWithTransparency(gfx, X, Y, layer);
+	}
+}
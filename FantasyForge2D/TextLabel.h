@@ -0,0 +1,36 @@
+#pragma once
+#include "GraphicText.h"
+#include <string>
+
+class TextLabel
+{
+private:
+	std::shared_ptr<const Charset> pCharset;
+	std::string text;
+	Color textColor;
+	unsigned int textScale;
+	std::optional<Image> textTexture;
+	bool isUsingTexture;
+	mutable Image image;
+	mutable std::string renderedText;
+	mutable bool isStyleDirty;
+private:
+	void Render() const;
+public:
+	TextLabel() = delete;
+	TextLabel(const GraphicText& font, std::string text = "", Color color = Colors::White, unsigned int scale = 1u);
+	void SetText(std::string new_text);
+	const std::string& GetText() const;
+	void SetTextColor(const Color& color);
+	const Color& GetTextColor() const;
+	void SetTextScale(unsigned int scale);
+	const unsigned int& GetTextScale() const;
+	void SetTextTexture(const Image& texture);
+	void UseTextTexture();
+	void UseTextColor();
+	bool IsUsingTextTexture() const;
+	bool IsDirty() const;
+	vec2u GetDimensions() const;
+	const Image& GetImage() const;
+	void Draw(Graphics& gfx, int X, int Y, unsigned int layer = 0u) const;
+};
@@ -0,0 +1,413 @@
+#include "Tilemap.h"
+#include "Sprite.h"
+#include <algorithm>
+
+Tilemap::Tilemap(uint2 map_dim, uint2 tile_size, vec2 pos)
+	:
+	position(pos),
+	width(map_dim.x),
+	height(map_dim.y),
+	tileWidth(tile_size.x),
+	tileHeight(tile_size.y),
+	nChunksX((map_dim.x + ChunkSize - 1u) / ChunkSize),
+	nChunksY((map_dim.y + ChunkSize - 1u) / ChunkSize)
+{
+	assert(width > 0u && height > 0u);
+	assert(tileWidth > 0u && tileHeight > 0u);
+	chunks.resize(nChunksX * nChunksY);
+	Clear();
+}
+
+Tilemap::Chunk& Tilemap::GetChunk(unsigned int x, unsigned int y)
+{
+	return chunks[(y / ChunkSize) * nChunksX + (x / ChunkSize)];
+}
+
+const Tilemap::Chunk& Tilemap::GetChunk(unsigned int x, unsigned int y) const
+{
+	return chunks[(y / ChunkSize) * nChunksX + (x / ChunkSize)];
+}
+
+uRect Tilemap::GetTileRange(const fRect& rect) const
+{
+	const vec2 rel = rect.pos - position;
+	const unsigned int x0 = (unsigned int)std::clamp(floorf(rel.x / (float)tileWidth), 0.0f, (float)width);
+	const unsigned int y0 = (unsigned int)std::clamp(floorf(rel.y / (float)tileHeight), 0.0f, (float)height);
+	const unsigned int x1 = (unsigned int)std::clamp(floorf((rel.x + rect.width) / (float)tileWidth) + 1.0f, 0.0f, (float)width);
+	const unsigned int y1 = (unsigned int)std::clamp(floorf((rel.y + rect.height) / (float)tileHeight) + 1.0f, 0.0f, (float)height);
+	return uRect({ x0,y0 }, x1 - std::min(x0, x1), y1 - std::min(y0, y1));
+}
+
+template <bool transparent>
+unsigned int Tilemap::DrawRange(Graphics& gfx, const Camera2D& camera, unsigned int layer) const
+{
+	assert(camera.GetZoom() > 0.0f);
+	const vec2 layerDim = gfx.GetDimensions_FLOAT(layer);
+	const Affine2D toScreen = camera.GetTransform() * Affine2D::Translation(layerDim.x / 2.0f, layerDim.y / 2.0f);
+	const Affine2D toWorld = toScreen.Inverse();
+	const uRect range = GetTileRange(toWorld.TransformRect(fRect({ 0.0f,0.0f }, layerDim)));
+	if (range.width == 0u || range.height == 0u)
+	{
+		return 0u;
+	}
+	const int layerWidth = (int)gfx.GetWidth(layer);
+	const int layerHeight = (int)gfx.GetHeight(layer);
+	const bool isRotated = toScreen.data[1][0] != 0.0f || toScreen.data[0][1] != 0.0f;
+	const float zoom = camera.GetZoom();
+	const bool isScaled = zoom != 1.0f;
+	const vec2 origin = toScreen.TransformPoint(position);
+	const int originX = (int)floorf(origin.x);
+	const int originY = (int)floorf(origin.y);
+	const float scaledTileWidth = (float)tileWidth * zoom;
+	const float scaledTileHeight = (float)tileHeight * zoom;
+	const int drawWidth = isScaled ? (int)ceilf(scaledTileWidth) : (int)tileWidth;
+	const int drawHeight = isScaled ? (int)ceilf(scaledTileHeight) : (int)tileHeight;
+	const unsigned int endX = range.pos.x + range.width;
+	const unsigned int endY = range.pos.y + range.height;
+	unsigned int nDrawn = 0u;
+	for (unsigned int cy = range.pos.y / ChunkSize; cy <= (endY - 1u) / ChunkSize; ++cy)
+	{
+		const unsigned int chunkY = cy * ChunkSize;
+		const unsigned int startTY = std::max(chunkY, range.pos.y);
+		const unsigned int endTY = std::min(chunkY + ChunkSize, endY);
+		for (unsigned int cx = range.pos.x / ChunkSize; cx <= (endX - 1u) / ChunkSize; ++cx)
+		{
+			const Chunk& chunk = chunks[cy * nChunksX + cx];
+			if (chunk.nTiles == 0u)
+			{
+				continue;
+			}
+			const unsigned int chunkX = cx * ChunkSize;
+			const unsigned int startTX = std::max(chunkX, range.pos.x);
+			const unsigned int endTX = std::min(chunkX + ChunkSize, endX);
+			for (unsigned int ty = startTY; ty < endTY; ++ty)
+			{
+				const unsigned short* pRow = chunk.tiles.data() + (ty - chunkY) * ChunkSize;
+				if (isRotated)
+				{
+					for (unsigned int tx = startTX; tx < endTX; ++tx)
+					{
+						const unsigned short type = pRow[tx - chunkX];
+						if (type != EmptyTile)
+						{
+							const vec2 tilePos = position + vec2((float)(tx * tileWidth), (float)(ty * tileHeight));
+							DrawRotatedTile<transparent>(gfx, tileTypes[type].pAnimation->GetCurrentFrame(), tilePos, toScreen, toWorld, layer);
+							++nDrawn;
+						}
+					}
+					continue;
+				}
+				const int Y = isScaled ? (int)floorf(origin.y + (float)ty * scaledTileHeight) : originY + (int)(ty * tileHeight);
+				if (Y >= layerHeight || Y + drawHeight <= 0)
+				{
+					continue;
+				}
+				for (unsigned int tx = startTX; tx < endTX; ++tx)
+				{
+					const unsigned short type = pRow[tx - chunkX];
+					if (type == EmptyTile)
+					{
+						continue;
+					}
+					const int X = isScaled ? (int)floorf(origin.x + (float)tx * scaledTileWidth) : originX + (int)(tx * tileWidth);
+					if (X >= layerWidth || X + drawWidth <= 0)
+					{
+						continue;
+					}
+					const Image& frame = tileTypes[type].pAnimation->GetCurrentFrame();
+					if constexpr (transparent)
+					{
+						if (isScaled)
+						{
+							frame.DrawWithTransparency(gfx, X, Y, (unsigned int)drawWidth, (unsigned int)drawHeight, layer);
+						}
+						else
+						{
+							frame.DrawWithTransparency(gfx, X, Y, layer);
+						}
+					}
+					else
+					{
+						if (isScaled)
+						{
+							frame.Draw(gfx, X, Y, (unsigned int)drawWidth, (unsigned int)drawHeight, layer);
+						}
+						else
+						{
+							frame.Draw(gfx, X, Y, layer);
+						}
+					}
+					++nDrawn;
+				}
+			}
+		}
+	}
+	return nDrawn;
+}
+
+template <bool transparent>
+void Tilemap::DrawRotatedTile(Graphics& gfx, const Image& frame, vec2 tile_pos, const Affine2D& to_screen, const Affine2D& to_world, unsigned int layer) const
+{
+	const fRect bounds = to_screen.TransformRect(fRect(tile_pos, (float)tileWidth, (float)tileHeight));
+	const int xRes = (int)gfx.GetWidth(layer);
+	const int yRes = (int)gfx.GetHeight(layer);
+	const int x0 = std::max((int)floorf(bounds.pos.x), 0);
+	const int y0 = std::max((int)floorf(bounds.pos.y), 0);
+	const int x1 = std::min((int)ceilf(bounds.pos.x + bounds.width), xRes);
+	const int y1 = std::min((int)ceilf(bounds.pos.y + bounds.height), yRes);
+	if (x0 >= x1 || y0 >= y1)
+	{
+		return;
+	}
+	const vec2 stepX = to_world.TransformVector({ 1.0f,0.0f });
+	const vec2 stepY = to_world.TransformVector({ 0.0f,1.0f });
+	const float w = (float)tileWidth;
+	const float h = (float)tileHeight;
+	std::vector<Color>& pixels = gfx.GetPixelMap(layer);
+	vec2 rowStart = to_world.TransformPoint({ (float)x0 + 0.5f,(float)y0 + 0.5f }) - tile_pos;
+	for (int y = y0; y < y1; ++y, rowStart += stepY)
+	{
+		vec2 local = rowStart;
+		for (int x = x0; x < x1; ++x, local += stepX)
+		{
+			if (local.x >= 0.0f && local.x < w && local.y >= 0.0f && local.y < h)
+			{
+				const Color& c = frame.GetPixel((unsigned int)local.x, (unsigned int)local.y);
+				if constexpr (transparent)
+				{
+					if (!c.GetA())
+					{
+						continue;
+					}
+				}
+				pixels[y * xRes + x] = c;
+			}
+		}
+	}
+}
+
+unsigned short Tilemap::AddTileType(Animation& animation, bool is_solid)
+{
+	assert(animation.GetFrameWidth() == tileWidth);
+	assert(animation.GetFrameHeight() == tileHeight);
+	assert(tileTypes.size() < EmptyTile);
+	tileTypes.push_back({ &animation,is_solid });
+	if (animationSet.insert(&animation).second)
+	{
+		animations.push_back(&animation);
+	}
+	return (unsigned short)(tileTypes.size() - 1u);
+}
+
+unsigned int Tilemap::GetTileTypeCount() const
+{
+	return (unsigned int)tileTypes.size();
+}
+
+Animation& Tilemap::GetAnimation(unsigned short type)
+{
+	assert(type < tileTypes.size());
+	return *tileTypes[type].pAnimation;
+}
+
+const Animation& Tilemap::GetAnimation(unsigned short type) const
+{
+	assert(type < tileTypes.size());
+	return *tileTypes[type].pAnimation;
+}
+
+void Tilemap::SetSolid(unsigned short type, bool is_solid)
+{
+	assert(type < tileTypes.size());
+	tileTypes[type].isSolid = is_solid;
+}
+
+bool Tilemap::IsSolid(unsigned short type) const
+{
+	assert(type < tileTypes.size());
+	return tileTypes[type].isSolid;
+}
+
+void Tilemap::SetTile(unsigned int x, unsigned int y, unsigned short type)
+{
+	assert(x < width && y < height);
+	assert(type == EmptyTile || type < tileTypes.size());
+	Chunk& chunk = GetChunk(x, y);
+	unsigned short& tile = chunk.tiles[(y % ChunkSize) * ChunkSize + (x % ChunkSize)];
+	chunk.nTiles += (tile == EmptyTile && type != EmptyTile);
+	chunk.nTiles -= (tile != EmptyTile && type == EmptyTile);
+	tile = type;
+}
+
+unsigned short Tilemap::GetTile(unsigned int x, unsigned int y) const
+{
+	assert(x < width && y < height);
+	return GetChunk(x, y).tiles[(y % ChunkSize) * ChunkSize + (x % ChunkSize)];
+}
+
+void Tilemap::ClearTile(unsigned int x, unsigned int y)
+{
+	SetTile(x, y, EmptyTile);
+}
+
+void Tilemap::Fill(const uRect& region, unsigned short type)
+{
+	assert(region.pos.x + region.width <= width);
+	assert(region.pos.y + region.height <= height);
+	for (unsigned int y = region.pos.y; y < region.pos.y + region.height; ++y)
+	{
+		for (unsigned int x = region.pos.x; x < region.pos.x + region.width; ++x)
+		{
+			SetTile(x, y, type);
+		}
+	}
+}
+
+void Tilemap::Clear()
+{
+	for (Chunk& chunk : chunks)
+	{
+		chunk.tiles.fill(EmptyTile);
+		chunk.nTiles = 0u;
+	}
+}
+
+void Tilemap::Move(vec2 delta)
+{
+	position += delta;
+}
+
+void Tilemap::SetPosition(vec2 pos)
+{
+	position = pos;
+}
+
+const vec2& Tilemap::GetPosition() const
+{
+	return position;
+}
+
+vec2u Tilemap::GetDimensions() const
+{
+	return { width,height };
+}
+
+vec2u Tilemap::GetTileSize() const
+{
+	return { tileWidth,tileHeight };
+}
+
+fRect Tilemap::GetRect() const
+{
+	return fRect(position, (float)(width * tileWidth), (float)(height * tileHeight));
+}
+
+fRect Tilemap::GetTileRect(unsigned int x, unsigned int y) const
+{
+	assert(x < width && y < height);
+	return fRect(position + vec2((float)(x * tileWidth), (float)(y * tileHeight)), (float)tileWidth, (float)tileHeight);
+}
+
+std::optional<vec2u> Tilemap::GetTileCoordinates(vec2 point) const
+{
+	const vec2 rel = point - position;
+	if (rel.x < 0.0f || rel.y < 0.0f)
+	{
+		return std::optional<vec2u>();
+	}
+	const unsigned int x = (unsigned int)(rel.x / (float)tileWidth);
+	const unsigned int y = (unsigned int)(rel.y / (float)tileHeight);
+	if (x >= width || y >= height)
+	{
+		return std::optional<vec2u>();
+	}
+	return vec2u(x, y);
+}
+
+fRect Tilemap::GetViewRect(const Camera2D& camera, vec2 view_dim) const
+{
+	const vec2 dim = view_dim / camera.GetZoom();
+	const float cosR = fabsf(cosf(camera.GetRotation()));
+	const float sinR = fabsf(sinf(camera.GetRotation()));
+	const vec2 bounds(dim.x * cosR + dim.y * sinR, dim.x * sinR + dim.y * cosR);
+	return fRect(camera.GetPosition() - bounds / 2.0f, bounds);
+}
+
+uRect Tilemap::GetVisibleChunkRange(const Camera2D& camera, vec2 view_dim) const
+{
+	const uRect tiles = GetTileRange(GetViewRect(camera, view_dim));
+	const unsigned int x0 = tiles.pos.x / ChunkSize;
+	const unsigned int y0 = tiles.pos.y / ChunkSize;
+	const unsigned int x1 = (tiles.pos.x + tiles.width + ChunkSize - 1u) / ChunkSize;
+	const unsigned int y1 = (tiles.pos.y + tiles.height + ChunkSize - 1u) / ChunkSize;
+	return uRect({ x0,y0 }, x1 - std::min(x0, x1), y1 - std::min(y0, y1));
+}
+
+unsigned short Tilemap::GetTileAt(vec2 point) const
+{
+	if (const auto coords = GetTileCoordinates(point))
+	{
+		return GetTile(coords->x, coords->y);
+	}
+	return EmptyTile;
+}
+
+bool Tilemap::IsSolidAt(vec2 point) const
+{
+	const unsigned short type = GetTileAt(point);
+	return type != EmptyTile && tileTypes[type].isSolid;
+}
+
+bool Tilemap::CollidedWith(const fRect& rect) const
+{
+	const uRect range = GetTileRange(rect);
+	for (unsigned int y = range.pos.y; y < range.pos.y + range.height; ++y)
+	{
+		for (unsigned int x = range.pos.x; x < range.pos.x + range.width; ++x)
+		{
+			const unsigned short type = GetTile(x, y);
+			if (type != EmptyTile && tileTypes[type].isSolid && rect.IsTouching(GetTileRect(x, y)))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool Tilemap::CollidedWith(const Sprite& sprite) const
+{
+	if (sprite.HasHitBoxes())
+	{
+		for (const fRect& hb : sprite.GetHitBoxes())
+		{
+			if (CollidedWith(hb))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+	else
+	{
+		return CollidedWith(sprite.GetRect());
+	}
+}
+
+void Tilemap::Update(float time_ellapsed)
+{
+	for (Animation* pAnimation : animations)
+	{
+		pAnimation->Play(time_ellapsed);
+	}
+}
+
+unsigned int Tilemap::Draw(Graphics& gfx, const Camera2D& camera, unsigned int layer) const
+{
+	return DrawRange<false>(gfx, camera, layer);
+}
+
+unsigned int Tilemap::DrawWithTransparency(Graphics& gfx, const Camera2D& camera, unsigned int layer) const
+{
+	return DrawRange<true>(gfx, camera, layer);
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include "Animation.h"
+#include "Camera2D.h"
+#include "Rect.h"
+#include <array>
+#include <optional>
+#include <unordered_set>
+
+class Sprite;
+
+class Tilemap
+{
+public:
+	static constexpr unsigned int ChunkSize = 16u;
+	static constexpr unsigned short EmptyTile = 0xFFFFu;
+private:
+	struct TileType
+	{
+		Animation* pAnimation;
+		bool isSolid;
+	};
+	struct Chunk
+	{
+		std::array<unsigned short, ChunkSize * ChunkSize> tiles;
+		unsigned int nTiles = 0u;
+	};
+private:
+	vec2 position;
+	const unsigned int width;
+	const unsigned int height;
+	const unsigned int tileWidth;
+	const unsigned int tileHeight;
+	const unsigned int nChunksX;
+	const unsigned int nChunksY;
+	std::vector<Chunk> chunks;
+	std::vector<TileType> tileTypes;
+	std::vector<Animation*> animations;
+	std::unordered_set<const Animation*> animationSet;
+private:
+	Chunk& GetChunk(unsigned int x, unsigned int y);
+	const Chunk& GetChunk(unsigned int x, unsigned int y) const;
+	uRect GetTileRange(const fRect& rect) const;
+	template <bool transparent>
+	unsigned int DrawRange(Graphics& gfx, const Camera2D& camera, unsigned int layer) const;
+	template <bool transparent>
+	void DrawRotatedTile(Graphics& gfx, const Image& frame, vec2 tile_pos, const Affine2D& to_screen, const Affine2D& to_world, unsigned int layer) const;
+public:
+	Tilemap() = delete;
+	Tilemap(uint2 map_dim, uint2 tile_size, vec2 pos = { 0.0f,0.0f });
+	unsigned short AddTileType(Animation& animation, bool is_solid = true);
+	unsigned int GetTileTypeCount() const;
+	Animation& GetAnimation(unsigned short type);
+	const Animation& GetAnimation(unsigned short type) const;
+	void SetSolid(unsigned short type, bool is_solid);
+	bool IsSolid(unsigned short type) const;
+	void SetTile(unsigned int x, unsigned int y, unsigned short type);
+	unsigned short GetTile(unsigned int x, unsigned int y) const;
+	void ClearTile(unsigned int x, unsigned int y);
+	void Fill(const uRect& region, unsigned short type);
+	void Clear();
+	void Move(vec2 delta);
+	void SetPosition(vec2 pos);
+	const vec2& GetPosition() const;
+	vec2u GetDimensions() const;
+	vec2u GetTileSize() const;
+	fRect GetRect() const;
+	fRect GetTileRect(unsigned int x, unsigned int y) const;
+	std::optional<vec2u> GetTileCoordinates(vec2 point) const;
+	fRect GetViewRect(const Camera2D& camera, vec2 view_dim) const;
+	uRect GetVisibleChunkRange(const Camera2D& camera, vec2 view_dim) const;
+	unsigned short GetTileAt(vec2 point) const;
+	bool IsSolidAt(vec2 point) const;
+	bool CollidedWith(const fRect& rect) const;
+	bool CollidedWith(const Sprite& sprite) const;
+	void Update(float time_ellapsed);
+	unsigned int Draw(Graphics& gfx, const Camera2D& camera, unsigned int layer = 0u) const;
+	unsigned int DrawWithTransparency(Graphics& gfx, const Camera2D& camera, unsigned int layer = 0u) const;
+};
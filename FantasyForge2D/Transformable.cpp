@@ -61,10 +61,12 @@ const vec2& Transformable::GetScale() const
 	return scale;
 }
 
+Affine2D Transformable::GetTransform() const
+{
+	return Affine2D::RotationScalingTranslation(rotation, scale, pos);
+}
+
 mat3 Transformable::GetTransformationMatrix() const
 {
-	return
-		mat3::RotationZ(rotation) *
-		mat3::Scaling(scale.x, scale.y, 1.0f) *
-		mat3::Translation(pos.x, pos.y);
+	return GetTransform().ToMat3();
 }
\ No newline at end of file
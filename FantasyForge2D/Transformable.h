@@ -1,5 +1,5 @@
 #pragma once
-#include "Vector.h"
+#include "Affine2D.h"
 
 class Transformable
 {
@@ -19,6 +19,7 @@ public:
 	virtual void Scale(vec2 scalar);
 	virtual void SetScale(vec2 new_scale);
 	virtual const vec2& GetScale() const;
+	virtual Affine2D GetTransform() const;
 	virtual mat3 GetTransformationMatrix() const;
 };
 
@@ -0,0 +1,214 @@
+#include "WaveFile.h"
+
+void WaveFile::Release()
+{
+	if (pView)
+	{
+		UnmapViewOfFile(pView);
+		pView = nullptr;
+	}
+	fileSize = 0u;
+	pData = nullptr;
+	nDataBytes = 0u;
+}
+
+WaveFile::WaveFile(const char* fileName)
+{
+	HANDLE hFile = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		throw SNDEXCPT_NOTE(HRESULT_FROM_WIN32(GetLastError()), "Could not open sound file!\n" + std::string(fileName));
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(hFile, &size) || size.QuadPart < LONGLONG(HeaderSize))
+	{
+		CloseHandle(hFile);
+		throw SNDEXCPT("RIFF .wav sound files only!\n" + std::string(fileName));
+	}
+	fileSize = size_t(size.QuadPart);
+	HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0u, 0u, nullptr);
+	CloseHandle(hFile);
+	if (!hMapping)
+	{
+		throw SNDEXCPT_NOTE(HRESULT_FROM_WIN32(GetLastError()), "Could not map sound file!\n" + std::string(fileName));
+	}
+	pView = static_cast<const BYTE*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0u, 0u, 0u));
+	CloseHandle(hMapping);
+	if (!pView)
+	{
+		throw SNDEXCPT_NOTE(HRESULT_FROM_WIN32(GetLastError()), "Could not map sound file!\n" + std::string(fileName));
+	}
+	UINT32 riff = 0u;
+	UINT32 wave = 0u;
+	memcpy(&riff, pView, 4u);
+	memcpy(&wave, pView + 8u, 4u);
+	if (riff != RiffID)
+	{
+		Release();
+		throw SNDEXCPT("RIFF .wav sound files only!\n" + std::string(fileName));
+	}
+	if (wave != WaveID)
+	{
+		Release();
+		throw SNDEXCPT("Sound file must be of type .wav!\n" + std::string(fileName));
+	}
+	Chunk fmt;
+	Chunk data;
+	if (!FindChunks(pView, fileSize, fmt, data))
+	{
+		Release();
+		throw SNDEXCPT("Format or data chunk of .wav file not found!\n" + std::string(fileName));
+	}
+	try
+	{
+		ParseFormat(fmt.pData, fmt.size, format, fileName);
+	}
+	catch (...)
+	{
+		Release();
+		throw;
+	}
+	pData = data.pData;
+	nDataBytes = data.size - data.size % format.Format.nBlockAlign;
+}
+
+WaveFile::WaveFile(WaveFile&& wave) noexcept
+	:
+	pView(wave.pView),
+	fileSize(wave.fileSize),
+	format(wave.format),
+	pData(wave.pData),
+	nDataBytes(wave.nDataBytes)
+{
+	wave.pView = nullptr;
+	wave.Release();
+}
+
+WaveFile& WaveFile::operator=(WaveFile&& wave) noexcept
+{
+	if (this != &wave)
+	{
+		Release();
+		pView = wave.pView;
+		fileSize = wave.fileSize;
+		format = wave.format;
+		pData = wave.pData;
+		nDataBytes = wave.nDataBytes;
+		wave.pView = nullptr;
+		wave.Release();
+	}
+	return *this;
+}
+
+const WAVEFORMATEX& WaveFile::GetFormat() const
+{
+	return format.Format;
+}
+
+const WAVEFORMATEXTENSIBLE& WaveFile::GetFormatExtensible() const
+{
+	return format;
+}
+
+bool WaveFile::IsExtensible() const
+{
+	return format.Format.wFormatTag == WAVE_FORMAT_EXTENSIBLE;
+}
+
+const BYTE* WaveFile::GetData() const
+{
+	return pData;
+}
+
+const UINT32& WaveFile::GetDataSize() const
+{
+	return nDataBytes;
+}
+
+UINT32 WaveFile::GetSampleCount() const
+{
+	return nDataBytes / format.Format.nBlockAlign;
+}
+
+WaveFile::~WaveFile()
+{
+	Release();
+}
+
+bool WaveFile::NextChunk(const BYTE*& pCursor, const BYTE* pEnd, Chunk& chunk)
+{
+	if (pEnd - pCursor < ptrdiff_t(ChunkHeaderSize))
+	{
+		return false;
+	}
+	memcpy(&chunk.id, pCursor, 4u);
+	memcpy(&chunk.size, pCursor + 4u, 4u);
+	chunk.pData = pCursor + ChunkHeaderSize;
+	const size_t remaining = size_t(pEnd - chunk.pData);
+	if (chunk.size > remaining)
+	{
+		chunk.size = UINT32(remaining);
+	}
+	const size_t padded = size_t(chunk.size) + (chunk.size & 1u);
+	pCursor = chunk.pData + std::min(padded, remaining);
+	return true;
+}
+
+bool WaveFile::FindChunks(const BYTE* pFile, size_t size, Chunk& fmt, Chunk& data)
+{
+	UINT32 riffSize = 0u;
+	memcpy(&riffSize, pFile + 4u, 4u);
+	const BYTE* pCursor = pFile + HeaderSize;
+	const size_t riffEnd = riffSize >= 4u ? size_t(riffSize) + ChunkHeaderSize : size;
+	const BYTE* pEnd = pFile + std::min(size, riffEnd);
+	bool foundFmt = false;
+	Chunk chunk;
+	while (NextChunk(pCursor, pEnd, chunk))
+	{
+		if (chunk.id == FmtID)
+		{
+			fmt = chunk;
+			foundFmt = true;
+		}
+		else if (chunk.id == DataID)
+		{
+			data = chunk;
+			return foundFmt;
+		}
+	}
+	return false;
+}
+
+void WaveFile::ParseFormat(const BYTE* pFmt, UINT32 size, WAVEFORMATEXTENSIBLE& format, const std::string& fileName)
+{
+	if (size < 16u)
+	{
+		throw SNDEXCPT("Format chunk of .wav file is too small!\n" + fileName);
+	}
+	ZeroMemory(&format, sizeof(format));
+	memcpy(&format, pFmt, std::min(size, UINT32(sizeof(format))));
+	if (size < sizeof(WAVEFORMATEX))
+	{
+		format.Format.cbSize = 0;
+	}
+	if (format.Format.wFormatTag == WAVE_FORMAT_EXTENSIBLE)
+	{
+		if (size < sizeof(WAVEFORMATEXTENSIBLE) || format.Format.cbSize < sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX))
+		{
+			throw SNDEXCPT("Extensible format chunk of .wav file is incomplete!\n" + fileName);
+		}
+		format.Format.cbSize = WORD(sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX));
+	}
+	else if (format.Format.wFormatTag == WAVE_FORMAT_PCM || format.Format.wFormatTag == WAVE_FORMAT_IEEE_FLOAT)
+	{
+		format.Format.cbSize = 0;
+	}
+	else
+	{
+		format.Format.cbSize = WORD(std::min(UINT32(format.Format.cbSize), UINT32(sizeof(format) - sizeof(WAVEFORMATEX))));
+	}
+	if (format.Format.nChannels == 0 || format.Format.nBlockAlign == 0 || format.Format.nSamplesPerSec == 0)
+	{
+		throw SNDEXCPT("Format chunk of .wav file is invalid!\n" + fileName);
+	}
+}
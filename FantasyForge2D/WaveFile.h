@@ -0,0 +1,47 @@
+#pragma once
+#include "SoundSystem.h"
+#include <string>
+
+class WaveFile
+{
+public:
+	struct Chunk
+	{
+		UINT32 id;
+		UINT32 size;
+		const BYTE* pData;
+	};
+private:
+	const BYTE* pView = nullptr;
+	size_t fileSize = 0u;
+	WAVEFORMATEXTENSIBLE format;
+	const BYTE* pData = nullptr;
+	UINT32 nDataBytes = 0u;
+private:
+	void Release();
+public:
+	static constexpr UINT32 RiffID = 'FFIR';
+	static constexpr UINT32 WaveID = 'EVAW';
+	static constexpr UINT32 FmtID = ' tmf';
+	static constexpr UINT32 DataID = 'atad';
+	static constexpr UINT32 HeaderSize = 12u;
+	static constexpr UINT32 ChunkHeaderSize = 8u;
+public:
+	WaveFile() = delete;
+	WaveFile(const char* fileName);
+	WaveFile(const WaveFile& wave) = delete;
+	WaveFile operator =(const WaveFile& wave) = delete;
+	WaveFile(WaveFile&& wave) noexcept;
+	WaveFile& operator =(WaveFile&& wave) noexcept;
+	const WAVEFORMATEX& GetFormat() const;
+	const WAVEFORMATEXTENSIBLE& GetFormatExtensible() const;
+	bool IsExtensible() const;
+	const BYTE* GetData() const;
+	const UINT32& GetDataSize() const;
+	UINT32 GetSampleCount() const;
+	~WaveFile();
+public:
+	static bool NextChunk(const BYTE*& pCursor, const BYTE* pEnd, Chunk& chunk);
+	static bool FindChunks(const BYTE* pFile, size_t size, Chunk& fmt, Chunk& data);
+	static void ParseFormat(const BYTE* pFmt, UINT32 size, WAVEFORMATEXTENSIBLE& format, const std::string& fileName);
+};
@@ -53,12 +53,14 @@ LRESULT Window::WindowMessageProceedure(HWND hWnd, UINT Msg, WPARAM wParam, LPAR
 					mouse.OnMouseEnter();
 					SetCapture(hWnd);
 				}
+				SampleMouseMoves(hWnd, coords.x, coords.y);
 				mouse.OnMouseMove(coords.x, coords.y);
 			}
 			else
 			{
 				if (mouse.LeftIsClicked() || mouse.RightIsClicked())
 				{
+					SampleMouseMoves(hWnd, coords.x, coords.y);
 					mouse.OnMouseMove(coords.x, coords.y);
 				}
 				else
@@ -137,7 +139,52 @@ LRESULT Window::WindowMessageProceedure(HWND hWnd, UINT Msg, WPARAM wParam, LPAR
 	return DefWindowProc(hWnd, Msg, wParam, lParam);
 }
 
-Window::Window(unsigned int w, unsigned int h, std::string _title, std::vector<uint2> display_layer_dims)
+void Window::SampleMouseMoves(HWND hWnd, int x, int y)
+{
+	if (!mouse.isSampling())
+	{
+		return;
+	}
+	// the history is newest first and timed in GetTickCount milliseconds, which are mapped onto steady_clock from the current tick
+	POINT origin = { 0, 0 };
+	ClientToScreen(hWnd, &origin);
+	MOUSEMOVEPOINT current = {};
+	current.x = (origin.x + x) & 0xFFFF;
+	current.y = (origin.y + y) & 0xFFFF;
+	current.time = DWORD(GetMessageTime());
+	MOUSEMOVEPOINT history[64];
+	int nPoints = GetMouseMovePointsEx(sizeof(MOUSEMOVEPOINT), &current, history, 64, GMMP_USE_DISPLAY_POINTS);
+	if (nPoints <= 0)
+	{
+		history[0] = current;
+		nPoints = 1;
+	}
+	int nNew = 0;
+	for (; nNew < nPoints; ++nNew)
+	{
+		const MOUSEMOVEPOINT& point = history[nNew];
+		if (mouse.lastMovePoint && point.time == mouse.lastMovePoint->time && point.x == mouse.lastMovePoint->x && point.y == mouse.lastMovePoint->y)
+		{
+			break;
+		}
+	}
+	if (!mouse.lastMovePoint)
+	{
+		nNew = 1;
+	}
+	const auto now = std::chrono::steady_clock::now();
+	const DWORD tick = GetTickCount();
+	for (int i = nNew - 1; i >= 0; --i)
+	{
+		const MOUSEMOVEPOINT& point = history[i];
+		const int screenX = point.x > 32767 ? point.x - 65536 : point.x;
+		const int screenY = point.y > 32767 ? point.y - 65536 : point.y;
+		mouse.OnMouseSample(screenX - origin.x, screenY - origin.y, now - std::chrono::milliseconds(DWORD(tick - point.time)));
+	}
+	mouse.lastMovePoint = Mouse::MovePoint{ history[0].time, history[0].x, history[0].y };
+}
+
+Window::Window(unsigned int w, unsigned int h, std::string _title, std::vector<uint2> display_layer_dims, bool visible)
 	:
 	width(w),
 	height(h),
@@ -161,7 +208,10 @@ Window::Window(unsigned int w, unsigned int h, std::string _title, std::vector<u
 	{
 		throw WNDEXCPT_NOTE("Failed to create window!");
 	}
-	ShowWindow(hWnd, SW_SHOW);
+	if (visible)
+	{
+		ShowWindow(hWnd, SW_SHOW);
+	}
 	assert(!display_layer_dims.empty());
 #ifdef _DEBUG
 	for (unsigned int i = 0u; i < display_layer_dims.size(); ++i)
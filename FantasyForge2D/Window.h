@@ -103,8 +103,9 @@ private:
 	static LRESULT WINAPI WndMsgSetup(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam);
 	static LRESULT WINAPI WndMsgForward(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam);
 	LRESULT WindowMessageProceedure(HWND hWnd, UINT Msg, WPARAM wParam, LPARAM lParam);
+	void SampleMouseMoves(HWND hWnd, int x, int y);
 public:
-	Window(unsigned int w, unsigned int h, std::string _title, std::vector<uint2> display_layer_dims);
+	Window(unsigned int w, unsigned int h, std::string _title, std::vector<uint2> display_layer_dims, bool visible = true);
 	const unsigned int& GetWidth() const;
 	const unsigned int& GetHeight() const;
 	std::string GetWindowTitle() const;